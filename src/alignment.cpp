@@ -1,5 +1,7 @@
 #include "alignment.hpp"
 #include "stream.hpp"
+#include "htslib/bgzf.h"
+#include "htslib/thread_pool.h"
 
 namespace vg {
 
@@ -26,36 +28,89 @@ int hts_for_each_parallel(string& filename, function<void(Alignment&)> lambda) {
 
     samFile *in = hts_open(filename.c_str(), "r");
     if (in == NULL) return 0;
+
+    // let htslib decompress BGZF blocks on a pool of its own threads
+    int thread_count = get_thread_count();
+    htsThreadPool pool = {NULL, 0};
+    if (thread_count > 1) {
+        pool.pool = hts_tpool_init(thread_count);
+        if (pool.pool) {
+            hts_set_opt(in, HTS_OPT_THREAD_POOL, &pool);
+        }
+    }
+
     bam_hdr_t *hdr = sam_hdr_read(in);
     map<string, string> rg_sample;
     parse_rg_sample_map(hdr->text, rg_sample);
 
-    int thread_count = get_thread_count();
-    vector<bam1_t*> bs; bs.resize(thread_count);
-    for (auto& b : bs) {
-        b = bam_init1();
-    }
+    // records will be handed off to worker threads in batches of this many
+    const size_t batch_size = 2048;
+    // max # of such batches to be holding in memory
+    const uint64_t max_batches_outstanding = 64;
+    // number of batches currently being processed
+    uint64_t batches_outstanding = 0;
+
+    // convert and process a batch of records, and free it
+    auto process_batch = [&](vector<bam1_t*>* batch) {
+        for (auto b : *batch) {
+            Alignment a = bam_to_alignment(b, rg_sample);
+            bam_destroy1(b);
+            lambda(a);
+        }
+        delete batch;
+    };
 
-    bool more_data = true;
-#pragma omp parallel shared(in, hdr, more_data, rg_sample)
+    // records are read on one thread and converted on the workers
+#pragma omp parallel shared(in, hdr, process_batch, batches_outstanding)
+#pragma omp single
     {
-        int tid = omp_get_thread_num();
+        bool more_data = true;
         while (more_data) {
-            bam1_t* b = bs[tid];
-#pragma omp critical (hts_input)
-            if (more_data) {
-                more_data = sam_read1(in, hdr, b) >= 0;
+            vector<bam1_t*>* batch = new vector<bam1_t*>();
+            batch->reserve(batch_size);
+            while (batch->size() < batch_size) {
+                bam1_t* b = bam_init1();
+                if (sam_read1(in, hdr, b) < 0) {
+                    bam_destroy1(b);
+                    more_data = false;
+                    break;
+                }
+                batch->push_back(b);
+            }
+            if (batch->empty()) {
+                delete batch;
+                break;
             }
-            if (more_data) {
-                Alignment a = bam_to_alignment(b, rg_sample);
-                lambda(a);
+
+            uint64_t outstanding;
+#pragma omp atomic read
+            outstanding = batches_outstanding;
+            if (omp_get_num_threads() == 1 || outstanding >= max_batches_outstanding) {
+                // Convert the batch here rather than wait for the workers.
+                // Waiting would never reach a task scheduling point, and with
+                // a small team the runtime may have queued the outstanding
+                // tasks for this very thread to run.
+                process_batch(batch);
+                continue;
+            }
+            // spawn task to convert and process this batch
+#pragma omp atomic update
+            batches_outstanding++;
+#pragma omp task firstprivate(batch) shared(process_batch, batches_outstanding)
+            {
+                process_batch(batch);
+#pragma omp atomic update
+                batches_outstanding--;
             }
         }
+#pragma omp taskwait
     }
 
-    for (auto& b : bs) bam_destroy1(b);
     bam_hdr_destroy(hdr);
     hts_close(in);
+    if (pool.pool) {
+        hts_tpool_destroy(pool.pool);
+    }
     return 1;
 
 }
@@ -140,129 +195,213 @@ bool get_next_alignment_pair_from_fastqs(gzFile fp1, gzFile fp2, char* buffer, s
 }
 
 
-size_t fastq_unpaired_for_each_parallel(string& filename, function<void(Alignment&)> lambda) {
-    gzFile fp = (filename != "-") ? gzopen(filename.c_str(), "r") : gzdopen(fileno(stdin), "r");
-    if (!fp) {
-        cerr << "[vg::alignment.cpp] couldn't open " << filename << endl; exit(1);
+/// Reads the text of whole FASTQ records from a file, plain or gzipped, in
+/// large blocks. BGZF input is inflated in parallel on htslib's threads.
+class FastqBlockReader {
+public:
+    FastqBlockReader(const string& filename) {
+        fp = (filename != "-") ? bgzf_open(filename.c_str(), "r") : bgzf_dopen(fileno(stdin), "r");
+        if (!fp) {
+            cerr << "[vg::alignment.cpp] couldn't open " << filename << endl; exit(1);
+        }
+        // this does nothing for input that isn't BGZF
+        bgzf_mt(fp, get_thread_count(), 256);
     }
-    size_t len = 2 << 18; // 256k
-    size_t nLines = 0;
-    int thread_count = get_thread_count();
-    //vector<Alignment> alns; alns.resize(thread_count);
-    vector<char*> bufs; bufs.resize(thread_count);
-    for (auto& buf : bufs) {
-        buf = new char[len];
+    
+    ~FastqBlockReader() {
+        bgzf_close(fp);
     }
-    bool more_data = true;
-#pragma omp parallel shared(fp, more_data, bufs)
-    {
-        int tid = omp_get_thread_num();
-        while (more_data) {
-            Alignment aln;
-            char* buf = bufs[tid];
-            bool got_anything = false;
-#pragma omp critical (fastq_input)
-            {
-                if (more_data) {
-                    got_anything = more_data = get_next_alignment_from_fastq(fp, buf, len, aln);
-                    nLines++;
+    
+    /// Append the text of up to count records to block, and return how many
+    /// were appended. Returns fewer than count only at the end of the file.
+    size_t read_records(size_t count, string& block) {
+        // drop what we handed out last time
+        pending.erase(0, start);
+        start = 0;
+        
+        size_t records = 0;
+        size_t lines = 0;
+        size_t scan = 0;
+        while (records < count) {
+            size_t newline = pending.find('\n', scan);
+            if (newline == string::npos) {
+                if (fill()) {
+                    continue;
                 }
+                break;
             }
-            if (got_anything) {
-                lambda(aln);
+            scan = newline + 1;
+            if (++lines == 4) {
+                block.append(pending, start, scan - start);
+                start = scan;
+                lines = 0;
+                records++;
             }
         }
+        
+        if (records < count && start < pending.size()) {
+            // we're at the end of the file with something left over
+            if (lines == 3 && scan < pending.size()) {
+                // the last record just doesn't end in a newline
+                block.append(pending, start, string::npos);
+                block.push_back('\n');
+                records++;
+            } else if (pending.find_first_not_of(" \t\r\n", start) != string::npos) {
+                cerr << "[vg::alignment.cpp] error: incomplete fastq record" << endl; exit(1);
+            }
+            start = pending.size();
+        }
+        
+        return records;
+    }
+    
+private:
+    
+    /// Read another block onto the end of pending. Returns false at the end
+    /// of the file.
+    bool fill() {
+        if (eof) {
+            return false;
+        }
+        size_t old_size = pending.size();
+        pending.resize(old_size + block_size);
+        ssize_t got = bgzf_read(fp, &pending[old_size], block_size);
+        if (got < 0) {
+            cerr << "[vg::alignment.cpp] error: could not read fastq input" << endl; exit(1);
+        }
+        pending.resize(old_size + got);
+        eof = (got == 0);
+        return !eof;
     }
-    for (auto& buf : bufs) {
-        delete[] buf;
+    
+    static const size_t block_size = 1 << 20; // 1M
+    BGZF* fp;
+    /// Text read from the file but not yet handed out, from start on
+    string pending;
+    size_t start = 0;
+    bool eof = false;
+};
+
+/// Parse the text of whole FASTQ records, as produced by
+/// FastqBlockReader::read_records, into alignments.
+void parse_fastq_records(const string& block, vector<Alignment>& alignments) {
+    size_t line_start = 0;
+    size_t line = 0;
+    while (line_start < block.size()) {
+        size_t line_end = block.find('\n', line_start);
+        switch (line++ % 4) {
+        case 0:
+            // trim off leading @, keep trailing /1 /2
+            alignments.emplace_back();
+            alignments.back().set_name(block.substr(line_start + 1, line_end - line_start - 1));
+            break;
+        case 1:
+            alignments.back().set_sequence(block.substr(line_start, line_end - line_start));
+            break;
+        case 2:
+            // "+" sep
+            break;
+        case 3:
+            alignments.back().set_quality(string_quality_char_to_short(block.substr(line_start, line_end - line_start)));
+            break;
+        }
+        line_start = line_end + 1;
     }
-    gzclose(fp);
-    return nLines;
 }
 
-size_t fastq_paired_interleaved_for_each_parallel(string& filename, function<void(Alignment&, Alignment&)> lambda) {
-    gzFile fp = (filename != "-") ? gzopen(filename.c_str(), "r") : gzdopen(fileno(stdin), "r");
-    if (!fp) {
-        cerr << "[vg::alignment.cpp] couldn't open " << filename << endl; exit(1);
-    }
-    size_t len = 2 << 18; // 256k
-    size_t nLines = 0;
-    int thread_count = get_thread_count();
-    //vector<Alignment> alns; alns.resize(thread_count);
-    vector<char*> bufs; bufs.resize(thread_count);
-    for (auto& buf : bufs) {
-        buf = new char[len];
-    }
-    bool more_data = true;
-#pragma omp parallel shared(fp, more_data, bufs)
+/// Read batches of records, the same number from each of the readers, on one
+/// thread, and hand them off to be parsed and processed by lambda on worker
+/// threads. Stops when any of the readers runs out. Returns the number of
+/// records read from each reader.
+size_t fastq_batches_for_each_parallel(vector<FastqBlockReader*>& readers, size_t batch_records,
+                                       const function<void(vector<vector<Alignment>>&)>& lambda) {
+
+    // max # of batches to be holding in memory
+    const uint64_t max_batches_outstanding = 256;
+    // number of batches currently being processed
+    uint64_t batches_outstanding = 0;
+    size_t total_records = 0;
+
+#pragma omp parallel shared(readers, lambda, batches_outstanding, total_records)
+#pragma omp single
     {
-        int tid = omp_get_thread_num();
-        while (more_data) {
-            Alignment mate1, mate2;
-            char* buf = bufs[tid];
-            bool got_anything = false;
-#pragma omp critical (fastq_input)
+        while (true) {
+            vector<string>* batch = new vector<string>(readers.size());
+            size_t records = batch_records;
+            for (size_t i = 0; i < readers.size(); i++) {
+                // only take as many records from each reader as the ones
+                // before it had
+                records = readers[i]->read_records(records, batch->at(i));
+            }
+            if (records == 0) {
+                delete batch;
+                break;
+            }
+            total_records += records;
+
+            // block if we've hit max_batches_outstanding
+            uint64_t b;
+#pragma omp atomic capture
+            b = ++batches_outstanding;
+            while (b >= max_batches_outstanding) {
+                usleep(1000);
+#pragma omp atomic read
+                b = batches_outstanding;
+            }
+            // spawn task to parse and process this batch
+#pragma omp task firstprivate(batch, records) shared(batches_outstanding, lambda)
             {
-                if (more_data) {
-                    got_anything = more_data = get_next_interleaved_alignment_pair_from_fastq(fp, buf, len, mate1, mate2);
-                    nLines++;
+                vector<vector<Alignment>> alignments(batch->size());
+                for (size_t i = 0; i < batch->size(); i++) {
+                    alignments[i].reserve(records);
+                    parse_fastq_records(batch->at(i), alignments[i]);
+                    // a reader that came up short leaves unmatched records
+                    alignments[i].resize(records);
                 }
-            }
-            if (got_anything) {
-                lambda(mate1, mate2);
+                delete batch;
+                lambda(alignments);
+#pragma omp atomic update
+                batches_outstanding--;
             }
         }
+#pragma omp taskwait
     }
-    for (auto& buf : bufs) {
-        delete buf;
-    }
-    gzclose(fp);
-    return nLines;
+
+    return total_records;
+}
+
+size_t fastq_unpaired_for_each_parallel(string& filename, function<void(Alignment&)> lambda) {
+    FastqBlockReader reader(filename);
+    vector<FastqBlockReader*> readers{&reader};
+    return fastq_batches_for_each_parallel(readers, 512, [&](vector<vector<Alignment>>& alignments) {
+        for (auto& aln : alignments[0]) {
+            lambda(aln);
+        }
+    });
+}
+
+size_t fastq_paired_interleaved_for_each_parallel(string& filename, function<void(Alignment&, Alignment&)> lambda) {
+    FastqBlockReader reader(filename);
+    vector<FastqBlockReader*> readers{&reader};
+    // batches are an even number of records, so only the last can split a pair
+    size_t records = fastq_batches_for_each_parallel(readers, 1024, [&](vector<vector<Alignment>>& alignments) {
+        auto& alns = alignments[0];
+        for (size_t i = 0; i + 1 < alns.size(); i += 2) {
+            lambda(alns[i], alns[i + 1]);
+        }
+    });
+    return records / 2;
 }
 
 size_t fastq_paired_two_files_for_each_parallel(string& file1, string& file2, function<void(Alignment&, Alignment&)> lambda) {
-    gzFile fp1 = (file1 != "-") ? gzopen(file1.c_str(), "r") : gzdopen(fileno(stdin), "r");
-    if (!fp1) {
-        cerr << "[vg::alignment.cpp] couldn't open " << file1 << endl; exit(1);
-    }
-    gzFile fp2 = (file2 != "-") ? gzopen(file2.c_str(), "r") : gzdopen(fileno(stdin), "r");
-    if (!fp2) {
-        cerr << "[vg::alignment.cpp] couldn't open " << file2 << endl; exit(1);
-    }
-    size_t len = 2 << 18; // 256k
-    size_t nLines = 0;
-    int thread_count = get_thread_count();
-    //vector<Alignment> alns; alns.resize(thread_count);
-    vector<char*> bufs; bufs.resize(thread_count);
-    for (auto& buf : bufs) {
-        buf = new char[len];
-    }
-    bool more_data = true;
-#pragma omp parallel shared(fp1, fp2, more_data, bufs)
-    {
-        int tid = omp_get_thread_num();
-        while (more_data) {
-            Alignment mate1, mate2;
-            char* buf = bufs[tid];
-            bool got_anything = false;
-#pragma omp critical (fastq_input)
-            {
-                if (more_data) {
-                    got_anything = more_data = get_next_alignment_pair_from_fastqs(fp1, fp2, buf, len, mate1, mate2);
-                    nLines++;
-                }
-            }
-            if (got_anything) {
-                lambda(mate1, mate2);
-            }
+    FastqBlockReader reader1(file1);
+    FastqBlockReader reader2(file2);
+    vector<FastqBlockReader*> readers{&reader1, &reader2};
+    return fastq_batches_for_each_parallel(readers, 512, [&](vector<vector<Alignment>>& alignments) {
+        for (size_t i = 0; i < alignments[0].size(); i++) {
+            lambda(alignments[0][i], alignments[1][i]);
         }
-    }
-    for (auto& buf : bufs) {
-        delete buf;
-    }
-    gzclose(fp1);
-    gzclose(fp2);
-    return nLines;
+    });
 }
 
 
@@ -649,7 +788,11 @@ Alignment bam_to_alignment(const bam1_t *b, map<string, string>& rg_sample) {
     //if (!rg_sample
     string sname;
     if (!rg_sample.empty()) {
-        sname = rg_sample[string(rg)];
+        // don't insert into the map, as other threads may be reading it
+        auto found = rg_sample.find(string(rg));
+        if (found != rg_sample.end()) {
+            sname = found->second;
+        }
     }
 
     // Now name the read after the scaffold
@@ -220,9 +220,8 @@ string get_pileup_line(const map<int64_t, NodePileup>& node_pileups,
 Call2Vcf::PrimaryPath::PrimaryPath(AugmentedGraph& augmented, const string& ref_path_name, size_t ref_bin_size):
     ref_bin_size(ref_bin_size), index(augmented.graph, ref_path_name, true), name(ref_path_name)  {
 
-    // Follow the reference path and extract indexes we need: index by node ID,
+    // The member index holds the reference path's indexes: index by node ID,
     // index by node start, and the reconstructed path sequence.
-    PathIndex index(augmented.graph, ref_path_name, true);
 
     if (index.sequence.size() == 0) {
         // No empty reference paths allowed
@@ -236,35 +235,42 @@ Call2Vcf::PrimaryPath::PrimaryPath(AugmentedGraph& augmented, const string& ref_
         // No zero-sized bins allowed
         throw runtime_error("Reference bin size must be 1 or larger");
     }
-    // Start out all the bins empty.
-    binned_support = vector<Support>(max(1, int(index.sequence.size() / ref_bin_size)), Support());
-    
-    // Crunch the numbers on the reference and its read support. How much read
-    // support in total (node length * aligned reads) does the primary path get?
-    total_support = Support();
-    for(auto& pointerAndSupport : augmented.node_supports) {
-        if(index.by_id.count(pointerAndSupport.first->id())) {
-            // This is a primary path node. Add in the total read bases supporting it
-            total_support += pointerAndSupport.first->sequence().size() * pointerAndSupport.second;
-            
-            // We also update the total for the appropriate bin
-            int bin = index.by_id[pointerAndSupport.first->id()].first / ref_bin_size;
-            if (bin == binned_support.size()) {
-                --bin;
-            }
-            binned_support[bin] = binned_support[bin] + 
-                pointerAndSupport.first->sequence().size() * pointerAndSupport.second;
+    this->ref_bin_size = ref_bin_size;
+    
+    // Crunch the numbers on the reference and its read support. We keep
+    // running totals of the support (node length * aligned reads) along the
+    // path, so that the support in any range can be had by subtraction.
+    size_t occurrences = index.occurrence_count();
+    forward_prefix.reserve(occurrences + 1);
+    reverse_prefix.reserve(occurrences + 1);
+    forward_prefix.push_back(0);
+    reverse_prefix.push_back(0);
+    for (size_t i = 0; i < occurrences; i++) {
+        id_t node_id = index.occurrence_side(i).node;
+        
+        Support node_total;
+        if (index.by_id.at(node_id).first == index.occurrence_start(i)) {
+            // This is the occurrence the node is indexed under, so count it
+            Node* node = augmented.graph.get_node(node_id);
+            node_total = augmented.get_support(node) * node->sequence().size();
         }
+        forward_prefix.push_back(forward_prefix.back() + node_total.forward());
+        reverse_prefix.push_back(reverse_prefix.back() + node_total.reverse());
     }
     
-    // Average out the support bins too (in place)
+    // How much read support in total does the primary path get?
+    total_support = get_total_support_between(0, index.sequence.size());
+    
+    // Start out all the bins empty.
+    binned_support = vector<Support>(max(1, int(index.sequence.size() / ref_bin_size)), Support());
+    
+    // Fill in and average out the support bins, each over its actual size
     min_bin = 0;
     max_bin = 0;
     for (int i = 0; i < binned_support.size(); ++i) {
-        // Compute the average over the bin's actual size
-        binned_support[i] = binned_support[i] / (
-            i < binned_support.size() - 1 ? (double)ref_bin_size :
-            (double)(ref_bin_size + index.sequence.size() % ref_bin_size));
+        size_t bin_start = i * ref_bin_size;
+        size_t bin_end = i < binned_support.size() - 1 ? bin_start + ref_bin_size : index.sequence.size();
+        binned_support[i] = get_average_support_between(bin_start, bin_end);
             
         // See if it's a min or max
         if (binned_support[i] < binned_support[min_bin]) {
@@ -277,6 +283,24 @@ Call2Vcf::PrimaryPath::PrimaryPath(AugmentedGraph& augmented, const string& ref_
 
 }
 
+Support Call2Vcf::PrimaryPath::get_total_support_between(size_t start, size_t past_end) const {
+    // Find the node occurrences that start in the range
+    size_t first = index.next_occurrence(start);
+    size_t past_last = index.next_occurrence(past_end);
+    if (past_last <= first) {
+        return Support();
+    }
+    return make_support(forward_prefix[past_last] - forward_prefix[first],
+                        reverse_prefix[past_last] - reverse_prefix[first]);
+}
+
+Support Call2Vcf::PrimaryPath::get_average_support_between(size_t start, size_t past_end) const {
+    if (past_end <= start) {
+        return Support();
+    }
+    return get_total_support_between(start, past_end) / (double) (past_end - start);
+}
+
 const Support& Call2Vcf::PrimaryPath::get_support_at(size_t primary_path_offset) const {
     return get_bin(get_bin_index(primary_path_offset));
 }
@@ -314,7 +338,7 @@ Support Call2Vcf::PrimaryPath::get_average_support(const map<string, PrimaryPath
     // Track the total support overall
     Support total;
     // And the total number of bases
-    size_t bases;
+    size_t bases = 0;
     
     for (auto& kv : paths) {
         // Sum over all paths
@@ -420,6 +444,9 @@ void trace_traversal(const SnarlTraversal& traversal, const Snarl& site, functio
  * Get the min support, total support, bp size (to divide total by for average
  * support), and min likelihood for a traversal, optionally excluding the
  * material used by another traversal.
+ *
+ * TODO: This walks every visit of the traversal. Traversals can leave the
+ * primary path, so the path's prefix sums can't answer for them.
  */
 tuple<Support, Support, size_t, double> get_traversal_support(AugmentedGraph& augmented,
     SnarlManager& snarl_manager, const Snarl& site, const SnarlTraversal& traversal,
@@ -1200,8 +1227,20 @@ void Call2Vcf::call(
     // Find all the top-level sites
     list<const Snarl*> site_queue;
     
-    CactusUltrabubbleFinder finder(augmented.graph);
-    SnarlManager site_manager = finder.find_snarls();
+    // Either load the snarls or find them. The SnarlManager points into its
+    // own storage, so it has to be constructed in place rather than assigned.
+    string& snarls_filename = snarls_file;
+    SnarlManager site_manager = [&]() -> SnarlManager {
+        if (snarls_filename.empty()) {
+            CactusUltrabubbleFinder finder(augmented.graph);
+            return finder.find_snarls();
+        }
+        ifstream snarls_stream(snarls_filename);
+        if (!snarls_stream) {
+            throw runtime_error("Could not open snarls file " + snarls_filename);
+        }
+        return SnarlManager(snarls_stream);
+    }();
     
     site_manager.for_each_top_level_snarl_parallel([&](const Snarl* site) {
         // Stick all the sites in this vector.
@@ -1288,9 +1327,10 @@ void Call2Vcf::call(
     
     // We're going to remember what nodes and edges are covered by sites, so we
     // will know which nodes/edges aren't in any sites and may need generic
-    // presence/absence calls.
-    set<Node*> covered_nodes;
-    set<Edge*> covered_edges;
+    // presence/absence calls. Each thread keeps its own sets while genotyping.
+    int thread_count = get_thread_count();
+    vector<set<Node*>> thread_covered_nodes(thread_count);
+    vector<set<Edge*>> thread_covered_edges(thread_count);
     
     // When we genotype the sites into Locus objects, we will use this buffer for outputting them.
     vector<Locus> locus_buffer;
@@ -1298,417 +1338,467 @@ void Call2Vcf::call(
     // How many sites result in output?
     size_t called_loci = 0;
     
-    for(const Snarl* site : sites) {
-        // For every site, we're going to make a bunch of Locus objects
-        
-        // See if the site is on a primary path, so we can use binned support.
-        map<string, PrimaryPath>::iterator found_path = find_path(*site, primary_paths);
-        
-        // We need to figure out how much support a site ought to have
-        Support baseline_support;
-        if (expected_coverage != 0.0) {
-            // Use the specified coverage override
-            baseline_support.set_forward(expected_coverage / 2);
-            baseline_support.set_reverse(expected_coverage / 2);
-        } else if (found_path != primary_paths.end()) {
-            // We're on a primary path, so we can find the appropriate bin
-        
-            // Since the variable part of the site is after the first anchoring node, where does it start?
-            // Account for the site possibly being backward on the path.
-            size_t variation_start = min(found_path->second.get_index().by_id.at(site->start().node_id()).first
-                    + augmented.graph.get_node(site->start().node_id())->sequence().size(),
-                found_path->second.get_index().by_id.at(site->end().node_id()).first
-                    + augmented.graph.get_node(site->end().node_id())->sequence().size());
-            
-            // Look in the bins for the primary path to get the support there.
-            baseline_support = found_path->second.get_support_at(variation_start);
+    // Sites are genotyped in parallel, a batch at a time. Each site in the
+    // batch renders its VCF lines or Loci into its own slot, and the slots are
+    // written out in site order once the batch is done, so no output locks
+    // are needed and the output matches a single-threaded run.
+    size_t batch_size = thread_count * 64;
+    vector<string> site_vcf_text(batch_size);
+    vector<vector<Locus>> site_loci(batch_size);
+    vector<size_t> site_called_loci(batch_size);
+    
+    for (size_t batch_start = 0; batch_start < sites.size(); batch_start += batch_size) {
+        size_t batch_end = min(sites.size(), batch_start + batch_size);
+    
+#pragma omp parallel for schedule(dynamic, 1)
+        for (size_t site_number = batch_start; site_number < batch_end; site_number++) {
+            // For every site, we're going to make a bunch of Locus objects
+            const Snarl* site = sites[site_number];
+        
+            // Which output slot does this site use?
+            size_t slot = site_number - batch_start;
+            stringstream site_output;
+            vector<Locus>& loci_out = site_loci[slot];
+            size_t& site_called = site_called_loci[slot];
+            site_called = 0;
+        
+            set<Node*>& covered_nodes = thread_covered_nodes[omp_get_thread_num()];
+            set<Edge*>& covered_edges = thread_covered_edges[omp_get_thread_num()];
+        
+            // See if the site is on a primary path, so we can use binned support.
+            map<string, PrimaryPath>::iterator found_path = find_path(*site, primary_paths);
+        
+            // We need to figure out how much support a site ought to have
+            Support baseline_support;
+            if (expected_coverage != 0.0) {
+                // Use the specified coverage override
+                baseline_support.set_forward(expected_coverage / 2);
+                baseline_support.set_reverse(expected_coverage / 2);
+            } else if (found_path != primary_paths.end()) {
+                // We're on a primary path, so we can find the appropriate bin
+        
+                // Since the variable part of the site is after the first anchoring node, where does it start?
+                // Account for the site possibly being backward on the path.
+                size_t variation_start = min(found_path->second.get_index().by_id.at(site->start().node_id()).first
+                        + augmented.graph.get_node(site->start().node_id())->sequence().size(),
+                    found_path->second.get_index().by_id.at(site->end().node_id()).first
+                        + augmented.graph.get_node(site->end().node_id())->sequence().size());
+            
+                // Look in the bins for the primary path to get the support
+                // there. They were all filled from the prefix sums up front.
+                baseline_support = found_path->second.get_support_at(variation_start);
             
-        } else {
-            // Just use the primary paths' average support, which may be 0 if there are none.
-            baseline_support = PrimaryPath::get_average_support(primary_paths);
-        }
+            } else {
+                // Just use the primary paths' average support, which may be 0 if there are none.
+                baseline_support = PrimaryPath::get_average_support(primary_paths);
+            }
         
-        // This function emits the given variant on the given primary path, as
-        // VCF. It needs to take the site as an argument because it may be
-        // called for children of the site we're working on right now.
-        auto emit_variant = [&contig_names_by_path_name, &vcf, &augmented, &original_positions, this](const Locus& locus, PrimaryPath& primary_path, const Snarl* site) {
-        
-            // Note that the locus paths will traverse our site forward, which
-            // may make them backward along the primary path.
-            bool site_backward = (primary_path.get_index().by_id.at(site->start().node_id()).first >
-                primary_path.get_index().by_id.at(site->end().node_id()).first);
-        
-            // Unpack the genotype back into best and second-best allele
-            auto& genotype = locus.genotype(0);
-            int best_allele = genotype.allele(0);
-            // If we called a single allele, we've lost the second-best allele info. But we won't need it, so we can just say -1.
-            int second_best_allele = (genotype.allele_size() >= 2 && genotype.allele(0) != genotype.allele(1)) ?
-                genotype.allele(1) :
-                -1;
+            // This function emits the given variant on the given primary path, as
+            // VCF. It needs to take the site as an argument because it may be
+            // called for children of the site we're working on right now.
+            auto emit_variant = [&contig_names_by_path_name, &vcf, &augmented, &original_positions, &site_output, this](const Locus& locus, PrimaryPath& primary_path, const Snarl* site) {
+        
+                // Note that the locus paths will traverse our site forward, which
+                // may make them backward along the primary path.
+                bool site_backward = (primary_path.get_index().by_id.at(site->start().node_id()).first >
+                    primary_path.get_index().by_id.at(site->end().node_id()).first);
+        
+                // Unpack the genotype back into best and second-best allele
+                auto& genotype = locus.genotype(0);
+                int best_allele = genotype.allele(0);
+                // If we called a single allele, we've lost the second-best allele info. But we won't need it, so we can just say -1.
+                int second_best_allele = (genotype.allele_size() >= 2 && genotype.allele(0) != genotype.allele(1)) ?
+                    genotype.allele(1) :
+                    -1;
                 
-            // Populate this with original node IDs, from before augmentation.
-            set<id_t> original_nodes;
+                // Populate this with original node IDs, from before augmentation.
+                set<id_t> original_nodes;
                 
-            // Calculate the ID and sequence strings for all the alleles.
-            // TODO: we only use some of these
-            vector<string> sequences;
-            vector<string> id_lists;
-            // Also the flags for whether alts are reference (i.e. known)
-            vector<bool> is_ref;
-            
-            for (size_t i = 0; i < locus.allele_size(); i++) {
-                // For each allele path in the Locus
-                auto& path = locus.allele(i);
+                // Calculate the ID and sequence strings for all the alleles.
+                // TODO: we only use some of these
+                vector<string> sequences;
+                vector<string> id_lists;
+                // Also the flags for whether alts are reference (i.e. known)
+                vector<bool> is_ref;
+            
+                for (size_t i = 0; i < locus.allele_size(); i++) {
+                    // For each allele path in the Locus
+                    auto& path = locus.allele(i);
                 
-                // Make a stream for the sequence of the path
-                stringstream sequence_stream;
-                // And for the description of involved IDs
-                stringstream id_stream;
+                    // Make a stream for the sequence of the path
+                    stringstream sequence_stream;
+                    // And for the description of involved IDs
+                    stringstream id_stream;
                 
-                for (size_t j = 0; j < path.mapping_size(); j++) {
-                    // For each mapping along the path
-                    auto& mapping = path.mapping(j);
+                    for (size_t j = 0; j < path.mapping_size(); j++) {
+                        // For each mapping along the path
+                        auto& mapping = path.mapping(j);
                     
-                    // Record the sequence
-                    string node_sequence = augmented.graph.get_node(mapping.position().node_id())->sequence();
-                    if (mapping.position().is_reverse()) {
-                        node_sequence = reverse_complement(node_sequence);
-                    }
-                    sequence_stream << node_sequence;
+                        // Record the sequence
+                        string node_sequence = augmented.graph.get_node(mapping.position().node_id())->sequence();
+                        if (mapping.position().is_reverse()) {
+                            node_sequence = reverse_complement(node_sequence);
+                        }
+                        sequence_stream << node_sequence;
                     
-                    if (j != 0) {
-                        // Add a separator
-                        id_stream << "_";
-                    }
-                    // Record the ID
-                    id_stream << mapping.position().node_id();
+                        if (j != 0) {
+                            // Add a separator
+                            id_stream << "_";
+                        }
+                        // Record the ID
+                        id_stream << mapping.position().node_id();
                     
-                    if (original_positions.count(mapping.position().node_id())) {
-                        // This node is derived from an original graph node. Remember it.
-                        original_nodes.insert(id(original_positions[mapping.position().node_id()]));
-                    }
+                        if (original_positions.count(mapping.position().node_id())) {
+                            // This node is derived from an original graph node. Remember it.
+                            original_nodes.insert(id(original_positions.at(mapping.position().node_id())));
+                        }
                     
-                }
+                    }
                 
-                // Remember the descriptions of the alleles
-                if (site_backward) {
-                    sequences.push_back(reverse_complement(sequence_stream.str()));
-                } else {
-                    sequences.push_back(sequence_stream.str());
+                    // Remember the descriptions of the alleles
+                    if (site_backward) {
+                        sequences.push_back(reverse_complement(sequence_stream.str()));
+                    } else {
+                        sequences.push_back(sequence_stream.str());
+                    }
+                    id_lists.push_back(id_stream.str());
+                    // And whether they're reference or not
+                    is_ref.push_back(is_reference(path, augmented));
                 }
-                id_lists.push_back(id_stream.str());
-                // And whether they're reference or not
-                is_ref.push_back(is_reference(path, augmented));
-            }
             
-            // Start off declaring the variable part to start at the start of
-            // the first anchoring node. We'll clip it back later to just what's
-            // after the shared prefix.
-            size_t variation_start = min(primary_path.get_index().by_id.at(site->start().node_id()).first,
-                primary_path.get_index().by_id.at(site->end().node_id()).first);
-        
-            // Keep track of the alleles that actually need to go in the VCF:
-            // ref, best, and second-best (if any), some of which may overlap.
-            // This is the order they will show up in the variant.
-            vector<int> used_alleles;
-            used_alleles.push_back(0);
-            if (best_allele != 0) {
-                used_alleles.push_back(best_allele);
-            }
-            if(second_best_allele != -1 && second_best_allele != 0) {
-                used_alleles.push_back(second_best_allele);
-            }
+                // Start off declaring the variable part to start at the start of
+                // the first anchoring node. We'll clip it back later to just what's
+                // after the shared prefix.
+                size_t variation_start = min(primary_path.get_index().by_id.at(site->start().node_id()).first,
+                    primary_path.get_index().by_id.at(site->end().node_id()).first);
+        
+                // Keep track of the alleles that actually need to go in the VCF:
+                // ref, best, and second-best (if any), some of which may overlap.
+                // This is the order they will show up in the variant.
+                vector<int> used_alleles;
+                used_alleles.push_back(0);
+                if (best_allele != 0) {
+                    used_alleles.push_back(best_allele);
+                }
+                if(second_best_allele != -1 && second_best_allele != 0) {
+                    used_alleles.push_back(second_best_allele);
+                }
             
-            // Rewrite the sequences and variation_start to just represent the
-            // actually variable part, by dropping any common prefix and common
-            // suffix. We just do the whole thing in place, modifying the used
-            // entries in sequences.
+                // Rewrite the sequences and variation_start to just represent the
+                // actually variable part, by dropping any common prefix and common
+                // suffix. We just do the whole thing in place, modifying the used
+                // entries in sequences.
             
-            auto shared_prefix_length = [&](bool backward) {
-                size_t shortest_prefix = std::numeric_limits<size_t>::max();
+                auto shared_prefix_length = [&](bool backward) {
+                    size_t shortest_prefix = std::numeric_limits<size_t>::max();
                 
-                auto here = used_alleles.begin();
-                if (here == used_alleles.end()) {
-                    // No strings.
-                    // Say no prefix is in common...
-                    return (size_t) 0;
-                }
-                auto next = here;
-                next++;
+                    auto here = used_alleles.begin();
+                    if (here == used_alleles.end()) {
+                        // No strings.
+                        // Say no prefix is in common...
+                        return (size_t) 0;
+                    }
+                    auto next = here;
+                    next++;
                 
-                if (next == used_alleles.end()) {
-                    // Only one string.
-                    // Say no prefix is in common...
-                    return (size_t) 0;
-                }
+                    if (next == used_alleles.end()) {
+                        // Only one string.
+                        // Say no prefix is in common...
+                        return (size_t) 0;
+                    }
                 
-                while (next != used_alleles.end()) {
-                    // Consider each allele and the next one after it, as
-                    // long as we have both.
+                    while (next != used_alleles.end()) {
+                        // Consider each allele and the next one after it, as
+                        // long as we have both.
                 
-                    // Figure out the shorter and the longer string
-                    string* shorter = &sequences.at(*here);
-                    string* longer = &sequences.at(*next);
-                    if (shorter->size() > longer->size()) {
-                        swap(shorter, longer);
-                    }
+                        // Figure out the shorter and the longer string
+                        string* shorter = &sequences.at(*here);
+                        string* longer = &sequences.at(*next);
+                        if (shorter->size() > longer->size()) {
+                            swap(shorter, longer);
+                        }
                 
-                    // Calculate the match length for this pair
-                    size_t match_length;
-                    if (backward) {
-                        // Find out how far in from the right the first mismatch is.
-                        auto mismatch_places = std::mismatch(shorter->rbegin(), shorter->rend(), longer->rbegin());
-                        match_length = std::distance(shorter->rbegin(), mismatch_places.first);
-                    } else {
-                        // Find out how far in from the left the first mismatch is.
-                        auto mismatch_places = std::mismatch(shorter->begin(), shorter->end(), longer->begin());
-                        match_length = std::distance(shorter->begin(), mismatch_places.first);
-                    }
+                        // Calculate the match length for this pair
+                        size_t match_length;
+                        if (backward) {
+                            // Find out how far in from the right the first mismatch is.
+                            auto mismatch_places = std::mismatch(shorter->rbegin(), shorter->rend(), longer->rbegin());
+                            match_length = std::distance(shorter->rbegin(), mismatch_places.first);
+                        } else {
+                            // Find out how far in from the left the first mismatch is.
+                            auto mismatch_places = std::mismatch(shorter->begin(), shorter->end(), longer->begin());
+                            match_length = std::distance(shorter->begin(), mismatch_places.first);
+                        }
                     
-                    // The shared prefix of these strings limits the longest
-                    // prefix shared by all strings.
-                    shortest_prefix = min(shortest_prefix, match_length);
+                        // The shared prefix of these strings limits the longest
+                        // prefix shared by all strings.
+                        shortest_prefix = min(shortest_prefix, match_length);
                 
-                    here = next;
-                    ++next;
-                }
+                        here = next;
+                        ++next;
+                    }
                 
-                // Return the shortest universally shared prefix
-                return shortest_prefix;
-            };
-            // Trim off the shared prefix
-            size_t shared_prefix = shared_prefix_length(false);
-            for (auto allele : used_alleles) {
-                sequences[allele] = sequences[allele].substr(shared_prefix);
-            }
-            // Add it onto the start coordinate
-            variation_start += shared_prefix;
+                    // Return the shortest universally shared prefix
+                    return shortest_prefix;
+                };
+                // Trim off the shared prefix
+                size_t shared_prefix = shared_prefix_length(false);
+                for (auto allele : used_alleles) {
+                    sequences[allele] = sequences[allele].substr(shared_prefix);
+                }
+                // Add it onto the start coordinate
+                variation_start += shared_prefix;
             
-            // Then find and trim off the shared suffix
-            size_t shared_suffix = shared_prefix_length(true);
-            for (auto allele : used_alleles) {
-                sequences[allele] = sequences[allele].substr(0, sequences[allele].size() - shared_suffix);
-            }
+                // Then find and trim off the shared suffix
+                size_t shared_suffix = shared_prefix_length(true);
+                for (auto allele : used_alleles) {
+                    sequences[allele] = sequences[allele].substr(0, sequences[allele].size() - shared_suffix);
+                }
             
-            // Make a Variant
-            vcflib::Variant variant;
-            variant.sequenceName = contig_names_by_path_name.at(primary_path.get_name());
-            variant.setVariantCallFile(vcf);
-            variant.quality = 0;
-            // Position should be 1-based and offset with our offset option.
-            variant.position = variation_start + 1 + variant_offset;
-            
-            // Set the ID based on the IDs of the involved nodes. Note that the best
-            // allele may have no nodes (because it's a pure edge)
-            variant.id = id_lists.at(best_allele);
-            if(second_best_allele != -1 && !id_lists.at(second_best_allele).empty()) {
-                // Add the second best allele's nodes in.
-                variant.id += "-" + id_lists.at(second_best_allele);
-            }
+                // Make a Variant
+                vcflib::Variant variant;
+                variant.sequenceName = contig_names_by_path_name.at(primary_path.get_name());
+                variant.setVariantCallFile(vcf);
+                variant.quality = 0;
+                // Position should be 1-based and offset with our offset option.
+                variant.position = variation_start + 1 + variant_offset;
+            
+                // Set the ID based on the IDs of the involved nodes. Note that the best
+                // allele may have no nodes (because it's a pure edge)
+                variant.id = id_lists.at(best_allele);
+                if(second_best_allele != -1 && !id_lists.at(second_best_allele).empty()) {
+                    // Add the second best allele's nodes in.
+                    variant.id += "-" + id_lists.at(second_best_allele);
+                }
             
             
-            if(sequences.at(0).empty() ||
-                (best_allele != -1 && sequences.at(best_allele).empty()) ||
-                (second_best_allele != -1 && sequences.at(second_best_allele).empty())) {
+                if(sequences.at(0).empty() ||
+                    (best_allele != -1 && sequences.at(best_allele).empty()) ||
+                    (second_best_allele != -1 && sequences.at(second_best_allele).empty())) {
                 
-                // Fix up the case where we have an empty allele.
+                    // Fix up the case where we have an empty allele.
                 
-                // We need to grab the character before the variable part of the
-                // site in the reference.
-                assert(variation_start > 0);
-                string extra_base = char_to_string(primary_path.get_index().sequence.at(variation_start - 1));
+                    // We need to grab the character before the variable part of the
+                    // site in the reference.
+                    assert(variation_start > 0);
+                    string extra_base = char_to_string(primary_path.get_index().sequence.at(variation_start - 1));
                 
-                for(auto& seq : sequences) {
-                    // Stick it on the front of all the allele sequences
-                    seq = extra_base + seq;
-                }
+                    for(auto& seq : sequences) {
+                        // Stick it on the front of all the allele sequences
+                        seq = extra_base + seq;
+                    }
                 
-                // Budge the variant left
-                variant.position--;
-            }
+                    // Budge the variant left
+                    variant.position--;
+                }
             
-            // Add the ref allele to the variant
-            create_ref_allele(variant, sequences.front());
+                // Add the ref allele to the variant
+                create_ref_allele(variant, sequences.front());
             
-            // Add the best allele
-            assert(best_allele != -1);
-            int best_alt = add_alt_allele(variant, sequences.at(best_allele));
+                // Add the best allele
+                assert(best_allele != -1);
+                int best_alt = add_alt_allele(variant, sequences.at(best_allele));
             
-            int second_best_alt = (second_best_allele == -1) ? -1 : add_alt_allele(variant, sequences.at(second_best_allele));
+                int second_best_alt = (second_best_allele == -1) ? -1 : add_alt_allele(variant, sequences.at(second_best_allele));
             
             
-            // Say we're going to spit out the genotype for this sample.        
-            variant.format.push_back("GT");
-            auto& genotype_vector = variant.samples[sample_name]["GT"];
+                // Say we're going to spit out the genotype for this sample.        
+                variant.format.push_back("GT");
+                auto& genotype_vector = variant.samples[sample_name]["GT"];
 
-            if (locus.genotype_size() > 0) {
-                // We actually made a call. Emit the first genotype, which is the call.
+                if (locus.genotype_size() > 0) {
+                    // We actually made a call. Emit the first genotype, which is the call.
                 
-                // We need to rewrite the allele numbers to alt numbers, since
-                // we aren't keeping all the alleles in the VCF, so we can't use
-                // the natural conversion of Genotype to VCF genotype string.
+                    // We need to rewrite the allele numbers to alt numbers, since
+                    // we aren't keeping all the alleles in the VCF, so we can't use
+                    // the natural conversion of Genotype to VCF genotype string.
                 
-                // Emit parts into this stream
-                stringstream stream;
-                for (size_t i = 0; i < genotype.allele_size(); i++) {
-                    // For each allele called as present in the genotype
+                    // Emit parts into this stream
+                    stringstream stream;
+                    for (size_t i = 0; i < genotype.allele_size(); i++) {
+                        // For each allele called as present in the genotype
                     
-                    // Convert from allele number to alt number
-                    if (genotype.allele(i) == best_allele) {
-                        stream << best_alt;
-                    } else if (genotype.allele(i) == second_best_allele) {
-                        stream << second_best_alt;
-                    } else {
-                        throw runtime_error("Allele " + to_string(genotype.allele(i)) +
-                            " is not best or second-best and has no alt");
-                    }
+                        // Convert from allele number to alt number
+                        if (genotype.allele(i) == best_allele) {
+                            stream << best_alt;
+                        } else if (genotype.allele(i) == second_best_allele) {
+                            stream << second_best_alt;
+                        } else {
+                            throw runtime_error("Allele " + to_string(genotype.allele(i)) +
+                                " is not best or second-best and has no alt");
+                        }
                     
-                    if (i + 1 != genotype.allele_size()) {
-                        // Write a separator after all but the last one
-                        stream << (genotype.is_phased() ? '|' : '/');
+                        if (i + 1 != genotype.allele_size()) {
+                            // Write a separator after all but the last one
+                            stream << (genotype.is_phased() ? '|' : '/');
+                        }
                     }
-                }
                 
-                // Save the finished genotype
-                genotype_vector.push_back(stream.str());              
-            } else {
-                // Say there's no call here
-                genotype_vector.push_back("./.");
-            }
+                    // Save the finished genotype
+                    genotype_vector.push_back(stream.str());              
+                } else {
+                    // Say there's no call here
+                    genotype_vector.push_back("./.");
+                }
             
-            // Now fill in all the other variant info/format stuff
+                // Now fill in all the other variant info/format stuff
 
-            if((best_allele != 0 && is_ref.at(best_allele)) || 
-                (second_best_allele != 0 && second_best_allele != -1 && is_ref.at(second_best_allele))) {
-                // Flag the variant as reference if either of its two best alleles
-                // is known but not the primary path. Don't put in a false entry if
-                // it isn't known, because vcflib will spit out the flag anyway...
-                variant.infoFlags["XREF"] = true;
-            }
+                if((best_allele != 0 && is_ref.at(best_allele)) || 
+                    (second_best_allele != 0 && second_best_allele != -1 && is_ref.at(second_best_allele))) {
+                    // Flag the variant as reference if either of its two best alleles
+                    // is known but not the primary path. Don't put in a false entry if
+                    // it isn't known, because vcflib will spit out the flag anyway...
+                    variant.infoFlags["XREF"] = true;
+                }
             
-            for (auto id : original_nodes) {
-                // Add references to the relevant original nodes
-                variant.info["XSEE"].push_back(to_string(id));
-            }
+                for (auto id : original_nodes) {
+                    // Add references to the relevant original nodes
+                    variant.info["XSEE"].push_back(to_string(id));
+                }
             
-            for (size_t i = 1; i < variant.alleles.size(); i++) {
-                // Claculate the SVLEN for this non-reference allele
-                int64_t svlen = (int64_t) variant.alleles.at(i).size() - (int64_t) variant.alleles.at(0).size();
+                for (size_t i = 1; i < variant.alleles.size(); i++) {
+                    // Claculate the SVLEN for this non-reference allele
+                    int64_t svlen = (int64_t) variant.alleles.at(i).size() - (int64_t) variant.alleles.at(0).size();
                 
-                // Add it in
-                variant.info["SVLEN"].push_back(to_string(svlen));
-            }
+                    // Add it in
+                    variant.info["SVLEN"].push_back(to_string(svlen));
+                }
             
-            // Set up the depth format field
-            variant.format.push_back("DP");
-            // And allelic depth
-            variant.format.push_back("AD");
-            // And strand bias
-            variant.format.push_back("SB");
-            // Also allelic likelihoods (from minimum values found on their paths)
-            variant.format.push_back("AL");
-            // Also the alt allele depth
-            variant.format.push_back("XAAD");
-            
-            // Compute the total support for all the alts that will be appearing
-            Support total_support;
-            // And total alt allele depth for the alt alleles
-            Support alt_support;
-            for (int allele : used_alleles) {
-                // For all the alleles we are using, look at the support.
-                auto& support = locus.support(allele);
+                // Set up the depth format field
+                variant.format.push_back("DP");
+                // And allelic depth
+                variant.format.push_back("AD");
+                // And strand bias
+                variant.format.push_back("SB");
+                // Also allelic likelihoods (from minimum values found on their paths)
+                variant.format.push_back("AL");
+                // Also the alt allele depth
+                variant.format.push_back("XAAD");
+            
+                // Compute the total support for all the alts that will be appearing
+                Support total_support;
+                // And total alt allele depth for the alt alleles
+                Support alt_support;
+                for (int allele : used_alleles) {
+                    // For all the alleles we are using, look at the support.
+                    auto& support = locus.support(allele);
                 
-                // Set up allele-specific stats for the allele
-                variant.samples[sample_name]["AD"].push_back(to_string((int64_t)round(total(support))));
-                variant.samples[sample_name]["SB"].push_back(to_string((int64_t)round(support.forward())));
-                variant.samples[sample_name]["SB"].push_back(to_string((int64_t)round(support.reverse())));
-                variant.samples[sample_name]["AL"].push_back(to_string_ss(ln_to_log10(locus.allele_log_likelihood(allele))));
+                    // Set up allele-specific stats for the allele
+                    variant.samples[sample_name]["AD"].push_back(to_string((int64_t)round(total(support))));
+                    variant.samples[sample_name]["SB"].push_back(to_string((int64_t)round(support.forward())));
+                    variant.samples[sample_name]["SB"].push_back(to_string((int64_t)round(support.reverse())));
+                    variant.samples[sample_name]["AL"].push_back(to_string_ss(ln_to_log10(locus.allele_log_likelihood(allele))));
                 
-                // Sum up into total depth
-                total_support += support;
+                    // Sum up into total depth
+                    total_support += support;
                 
-                if (allele != 0) {
-                    // It's not the primary reference allele
-                    alt_support += support;
+                    if (allele != 0) {
+                        // It's not the primary reference allele
+                        alt_support += support;
+                    }
                 }
-            }
             
-            // Find the min total support of anything called
-            double min_site_support = INFINITY;
-            for (size_t i = 0; i < genotype.allele_size(); i++) {
-                // Min all the total supports from the alleles called as present
-                min_site_support = min(min_site_support, total(locus.support(genotype.allele(i))));
-            }
+                // Find the min total support of anything called
+                double min_site_support = INFINITY;
+                for (size_t i = 0; i < genotype.allele_size(); i++) {
+                    // Min all the total supports from the alleles called as present
+                    min_site_support = min(min_site_support, total(locus.support(genotype.allele(i))));
+                }
 
-            // Set the variant's total depth            
-            string depth_string = to_string((int64_t)round(total(total_support)));
-            variant.samples[sample_name]["DP"].push_back(depth_string);
-            variant.info["DP"].push_back(depth_string); // We only have one sample, so variant depth = sample depth
+                // Set the variant's total depth            
+                string depth_string = to_string((int64_t)round(total(total_support)));
+                variant.samples[sample_name]["DP"].push_back(depth_string);
+                variant.info["DP"].push_back(depth_string); // We only have one sample, so variant depth = sample depth
             
-            // And its depth of non-0 alleles
-            variant.samples[sample_name]["XAAD"].push_back(to_string((int64_t)round(total(alt_support))));
+                // And its depth of non-0 alleles
+                variant.samples[sample_name]["XAAD"].push_back(to_string((int64_t)round(total(alt_support))));
 
-            // Phred-ify the likelihood into a quality
-            variant.quality = -10. * log10(1. - pow(10, ln_to_log10(genotype.log_likelihood())));
+                // Phred-ify the likelihood into a quality
+                variant.quality = -10. * log10(1. - pow(10, ln_to_log10(genotype.log_likelihood())));
 
-            // Apply Min Allele Depth cutoff and store result in Filter column
-            variant.filter = min_site_support >= min_mad_for_filter ? "PASS" : "FAIL";
+                // Apply Min Allele Depth cutoff and store result in Filter column
+                variant.filter = min_site_support >= min_mad_for_filter ? "PASS" : "FAIL";
             
-            if(can_write_alleles(variant)) {
-                // No need to check for collisions because we assume sites are correctly found.
+                if(can_write_alleles(variant)) {
+                    // No need to check for collisions because we assume sites are correctly found.
                 
-                // Output the created VCF variant.
-                cout << variant << endl;
+                    // Output the created VCF variant.
+                    site_output << variant << endl;
                 
-            } else {
-                if (verbose) {
-                    cerr << "Variant is too large" << endl;
+                } else {
+                    if (verbose) {
+                        cerr << "Variant is too large" << endl;
+                    }
+                    // TODO: track bases lost again
                 }
-                // TODO: track bases lost again
-            }
             
-        };
+            };
         
-        // Recursively type the site, using that support and an assumption of a diploid sample.
-        find_best_traversals(augmented, site_manager, &traversal_finder, *site, baseline_support, 2,
-            [&locus_buffer, &emit_variant, &site_manager, &called_loci, &primary_paths, &augmented,
-            &covered_nodes, &covered_edges, this](const Locus& locus, const Snarl* site) {
+            // Recursively type the site, using that support and an assumption of a diploid sample.
+            find_best_traversals(augmented, site_manager, &traversal_finder, *site, baseline_support, 2,
+                [&loci_out, &emit_variant, &site_manager, &site_called, &primary_paths, &augmented,
+                &covered_nodes, &covered_edges, this](const Locus& locus, const Snarl* site) {
             
-            // Now we have the Locus with call information, and the site (either
-            // the root snarl we passed in or a child snarl) that the call is
-            // for. We need to output the call.
+                // Now we have the Locus with call information, and the site (either
+                // the root snarl we passed in or a child snarl) that the call is
+                // for. We need to output the call.
         
-            if (convert_to_vcf) {
-                // We want to emit VCF
+                if (convert_to_vcf) {
+                    // We want to emit VCF
                 
-                // Look up the path this child site lives on. (TODO: just capture and use the path the parent lives on?)
-                auto found_path = find_path(*site, primary_paths);
-                if(found_path != primary_paths.end()) {
-                    // And this site is on a primary path
+                    // Look up the path this child site lives on. (TODO: just capture and use the path the parent lives on?)
+                    auto found_path = find_path(*site, primary_paths);
+                    if(found_path != primary_paths.end()) {
+                        // And this site is on a primary path
                     
-                    // Emit the variant for this Locus
-                    emit_variant(locus, found_path->second, site);
+                        // Emit the variant for this Locus
+                        emit_variant(locus, found_path->second, site);
+                    }
+                    // Otherwise discard it as off-path
+                    // TODO: update bases lost
+                } else {
+                    // Emit the locus itself
+                    loci_out.push_back(locus);
                 }
-                // Otherwise discard it as off-path
-                // TODO: update bases lost
-            } else {
-                // Emit the locus itself
-                locus_buffer.push_back(locus);
-                stream::write_buffered(cout, locus_buffer, locus_buffer_size);
-            }
             
-            // We called a site
-            called_loci++;
+                // We called a site
+                site_called++;
             
-            // Mark all the nodes and edges in the site as covered
-            auto contents = site_manager.deep_contents(site, augmented.graph, true);
-            for (auto* node : contents.first) {
-                covered_nodes.insert(node);
-            }
-            for (auto* edge : contents.second) {
-                covered_edges.insert(edge);
+                // Mark all the nodes and edges in the site as covered
+                auto contents = site_manager.deep_contents(site, augmented.graph, true);
+                for (auto* node : contents.first) {
+                    covered_nodes.insert(node);
+                }
+                for (auto* edge : contents.second) {
+                    covered_edges.insert(edge);
+                }
+            });
+        
+            site_vcf_text[slot] = site_output.str();
+        }
+    
+        // Write out the batch in order
+        for (size_t slot = 0; slot < batch_end - batch_start; slot++) {
+            if (convert_to_vcf) {
+                cout << site_vcf_text[slot];
+                site_vcf_text[slot].clear();
+            } else {
+                for (auto& locus : site_loci[slot]) {
+                    locus_buffer.push_back(locus);
+                    stream::write_buffered(cout, locus_buffer, locus_buffer_size);
+                }
+                site_loci[slot].clear();
             }
-        });
+            called_loci += site_called_loci[slot];
+        }
+    }
+    
+    // Combine the per-thread records of covered material
+    set<Node*> covered_nodes;
+    set<Edge*> covered_edges;
+    for (int i = 0; i < thread_count; i++) {
+        covered_nodes.insert(thread_covered_nodes[i].begin(), thread_covered_nodes[i].end());
+        covered_edges.insert(thread_covered_edges[i].begin(), thread_covered_edges[i].end());
     }
     
     if (verbose) {
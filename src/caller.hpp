@@ -424,6 +424,19 @@ public:
          * Get the total support for the path.
          */
         Support get_total_support() const;
+        
+        /**
+         * Get the total support (per strand, in read bases) of the path nodes
+         * whose occurrences start in the given end-exclusive range of path
+         * offsets. Takes O(log n) time in the number of nodes on the path.
+         */
+        Support get_total_support_between(size_t start, size_t past_end) const;
+        
+        /**
+         * Get the average support per base over the given end-exclusive range
+         * of path offsets, counting nodes by where they start.
+         */
+        Support get_average_support_between(size_t start, size_t past_end) const;
     
         /**
          * Get the PathIndex for this primary path.
@@ -461,6 +474,15 @@ public:
         
         /// What's the total Support over every bin?
         Support total_support;
+        
+        /// Cumulative forward-strand support (in read bases) of all node
+        /// occurrences before each one, in the order of the PathIndex's
+        /// occurrence tables, with a final entry for the whole path.
+        /// Nodes visited more than once only count at their first occurrence.
+        vector<double> forward_prefix;
+        
+        /// Cumulative reverse-strand support, like forward_prefix.
+        vector<double> reverse_prefix;
     };
     
     
@@ -599,6 +621,11 @@ public:
     Option<size_t> average_support_switch_threshold{this, "use-avg-support-above", "uUaAtT", 100,
         "use average instead of minimum support for sites this long or longer"};
     
+    /// If set, load the augmented graph's snarls from this file (as written by
+    /// "vg snarls" on the graph saved with -A) instead of finding them again
+    Option<string> snarls_file{this, "snarls", "L", "",
+        "load snarls of the augmented graph from FILE instead of finding them"};
+    
     /// What's the maximum number of bubble path combinations we can explore
     /// while finding one with maximum support?
     size_t max_bubble_paths = 100;
@@ -159,4 +159,111 @@ int64_t PathChunker::extract_gam_for_ids(const vector<vg::id_t>& graph_ids,
 
 }
 
+int64_t PathChunker::extract_gam_for_chunks(istream& gam_stream, const vector<vector<vg::id_t>>& chunk_ids,
+                                            const vector<string>& chunk_gam_names) {
+
+    assert(chunk_ids.size() == chunk_gam_names.size());
+
+    // Collapse each chunk's ids into runs of consecutive ids, and turn the
+    // runs into events where a chunk starts or stops covering an id. 
+    vector<pair<vg::id_t, int64_t>> events;
+    for (size_t i = 0; i < chunk_ids.size(); ++i) {
+        vector<vg::id_t> ids = chunk_ids[i];
+        sort(ids.begin(), ids.end());
+        ids.erase(unique(ids.begin(), ids.end()), ids.end());
+        for (size_t j = 0; j < ids.size(); ) {
+            size_t k = j + 1;
+            while (k < ids.size() && ids[k] == ids[k - 1] + 1) {
+                ++k;
+            }
+            // chunk i covers [ids[j], ids[k - 1]].  we use ~i for a stop.
+            events.push_back(make_pair(ids[j], (int64_t)i));
+            events.push_back(make_pair(ids[k - 1] + 1, ~(int64_t)i));
+            j = k;
+        }
+    }
+    sort(events.begin(), events.end());
+
+    // Sweep the events to make a map from disjoint id intervals to the chunks
+    // covering them.  Interval s starts at segment_start[s] and runs up to the
+    // next start.  Its chunks are segment_chunks[segment_offset[s]] up to
+    // segment_chunks[segment_offset[s + 1]].
+    vector<vg::id_t> segment_start;
+    vector<size_t> segment_offset;
+    vector<size_t> segment_chunks;
+    set<size_t> active;
+    for (size_t i = 0; i < events.size(); ) {
+        vg::id_t pos = events[i].first;
+        for (; i < events.size() && events[i].first == pos; ++i) {
+            if (events[i].second >= 0) {
+                active.insert(events[i].second);
+            } else {
+                active.erase(~events[i].second);
+            }
+        }
+        segment_start.push_back(pos);
+        segment_offset.push_back(segment_chunks.size());
+        segment_chunks.insert(segment_chunks.end(), active.begin(), active.end());
+    }
+    segment_offset.push_back(segment_chunks.size());
+
+    // Start every chunk off empty, since we append as we go
+    for (auto& name : chunk_gam_names) {
+        ofstream out_file(name);
+        if (!out_file) {
+            cerr << "error[vg chunk]: can't open output gam file " << name << endl;
+            exit(1);
+        }
+    }
+
+    vector<vector<Alignment>> gam_buffers(chunk_ids.size());
+    int64_t gam_count = 0;
+
+    function<void(size_t)> flush_buffer = [&](size_t chunk) {
+        auto& gam_buffer = gam_buffers[chunk];
+        ofstream out_file(chunk_gam_names[chunk], ios_base::app);
+        if (!out_file) {
+            cerr << "error[vg chunk]: can't open output gam file " << chunk_gam_names[chunk] << endl;
+            exit(1);
+        }
+        gam_count += gam_buffer.size();
+        stream::write_buffered(out_file, gam_buffer, 0);
+    };
+
+    // The chunks an alignment is going to; reused between alignments
+    vector<size_t> targets;
+    
+    function<void(Alignment&)> lambda = [&](Alignment& alignment) {
+        targets.clear();
+        for (auto& mapping : alignment.path().mapping()) {
+            vg::id_t id = mapping.position().node_id();
+            auto it = upper_bound(segment_start.begin(), segment_start.end(), id);
+            if (it == segment_start.begin()) {
+                continue;
+            }
+            size_t segment = (it - segment_start.begin()) - 1;
+            targets.insert(targets.end(), segment_chunks.begin() + segment_offset[segment],
+                           segment_chunks.begin() + segment_offset[segment + 1]);
+        }
+        sort(targets.begin(), targets.end());
+        targets.erase(unique(targets.begin(), targets.end()), targets.end());
+
+        for (size_t chunk : targets) {
+            gam_buffers[chunk].push_back(alignment);
+            if (gam_buffers[chunk].size() >= gam_buffer_size) {
+                flush_buffer(chunk);
+            }
+        }
+    };
+    stream::for_each(gam_stream, lambda);
+
+    for (size_t chunk = 0; chunk < gam_buffers.size(); ++chunk) {
+        if (!gam_buffers[chunk].empty()) {
+            flush_buffer(chunk);
+        }
+    }
+
+    return gam_count;
+}
+
 }
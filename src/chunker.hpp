@@ -58,6 +58,18 @@ public:
 
     /** More general interface used by above two functions */
     int64_t extract_gam_for_ids(const vector<vg::id_t>& graph_ids, Index& index, ostream* out_stream);
+
+    /** Extract alignments for many chunks at once, without a rocksdb index,
+     * by reading through a gam stream a single time.  chunk_ids[i] holds the
+     * node ids of chunk i, and each alignment touching one of them is 
+     * appended to the file chunk_gam_names[i] (which is truncated first).
+     * Per-chunk buffers of this->gam_buffer_size alignments are flushed by 
+     * reopening the file, so any number of chunks can be written without
+     * keeping them all open.  The gam is ideally sorted by node id, which
+     * keeps the buffers flushing steadily.  Returns the total number of
+     * alignments written, counting each copy. */
+    int64_t extract_gam_for_chunks(istream& gam_stream, const vector<vector<vg::id_t>>& chunk_ids,
+                                   const vector<string>& chunk_gam_names);
 };
 
 
@@ -0,0 +1,753 @@
+#include "distance_index.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace vg {
+
+const string DistanceIndex::EXTENSION = ".dist";
+
+// Small enough that a few of them can be added without overflowing
+const int64_t DistanceIndex::UNREACHABLE = numeric_limits<int64_t>::max() / 8;
+
+template<typename T>
+static void write_vector(ostream& out, const vector<T>& items) {
+    size_t count = items.size();
+    out.write((const char*) &count, sizeof(count));
+    out.write((const char*) items.data(), count * sizeof(T));
+}
+
+template<typename T>
+static void read_vector(istream& in, vector<T>& items) {
+    size_t count = 0;
+    in.read((char*) &count, sizeof(count));
+    if (!in) {
+        throw runtime_error("DistanceIndex: truncated distance index");
+    }
+    items.resize(count);
+    in.read((char*) items.data(), count * sizeof(T));
+}
+
+// Spread the bits of a value over a 64-bit hash (the splitmix64 finalizer)
+static inline uint64_t mix_hash(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Hash a node by its ID and length
+static inline uint64_t node_hash(id_t node_id, size_t length) {
+    return mix_hash(mix_hash(node_id) ^ length);
+}
+
+// Hash an edge by the two node sides it joins, whichever way round it is
+// written down
+static inline uint64_t edge_hash(const Edge& edge) {
+    uint64_t from_side = mix_hash(2 * edge.from() + !edge.from_start());
+    uint64_t to_side = mix_hash(2 * edge.to() + edge.to_end());
+    return mix_hash(min(from_side, to_side) ^ mix_hash(max(from_side, to_side)));
+}
+
+DistanceIndex::DistanceIndex(VG& graph, SnarlManager& snarl_manager, size_t max_snarl_nodes) :
+    graph_nodes(graph.node_count()), graph_length(graph.length()) {
+
+    // Fingerprint the graph so we can tell if we are used with another one.
+    // Hashes are summed, so the order we see things in doesn't matter.
+    graph.for_each_node([&](Node* node) {
+        graph_hash += node_hash(node->id(), node->sequence().size());
+    });
+    graph.for_each_edge([&](Edge* edge) {
+        graph_edges++;
+        graph_hash += edge_hash(*edge);
+    });
+
+    // Number the snarls parents first, remembering who is whose parent
+    vector<const Snarl*> snarls;
+    vector<int64_t> parents;
+    vector<int64_t> depths;
+    vector<vector<int64_t>> children;
+    vector<pair<const Snarl*, int64_t>> stack;
+    for (const Snarl* root : snarl_manager.top_level_snarls()) {
+        stack.emplace_back(root, -1);
+    }
+    while (!stack.empty()) {
+        const Snarl* snarl = stack.back().first;
+        int64_t parent = stack.back().second;
+        stack.pop_back();
+        int64_t number = snarls.size();
+        snarls.push_back(snarl);
+        parents.push_back(parent);
+        depths.push_back(parent < 0 ? 0 : depths[parent] + 1);
+        children.emplace_back();
+        if (parent >= 0) {
+            children[parent].push_back(number);
+        }
+        for (const Snarl* child : snarl_manager.children_of(snarl)) {
+            stack.emplace_back(child, number);
+        }
+    }
+
+    // Group them by depth, so we can do all the children before their parents
+    int64_t max_depth = depths.empty() ? -1 : *max_element(depths.begin(), depths.end());
+    vector<vector<int64_t>> levels(max_depth + 1);
+    for (int64_t i = 0; i < snarls.size(); i++) {
+        levels[depths[i]].push_back(i);
+    }
+
+    snarl_records.resize(snarls.size());
+    vector<vector<id_t>> snarl_nodes(snarls.size());
+    vector<vector<int64_t>> snarl_boundaries(snarls.size());
+    vector<vector<int64_t>> snarl_matrices(snarls.size());
+
+    for (int64_t depth = max_depth; depth >= 0; depth--) {
+#pragma omp parallel for schedule(dynamic, 1)
+        for (size_t j = 0; j < levels[depth].size(); j++) {
+            int64_t number = levels[depth][j];
+            const Snarl* snarl = snarls[number];
+            SnarlRecord& record = snarl_records[number];
+            record.start_node = snarl->start().node_id();
+            record.start_backward = snarl->start().backward();
+            record.end_node = snarl->end().node_id();
+            record.end_backward = snarl->end().backward();
+            record.parent = parents[number];
+            record.depth = depth;
+
+            // the net graph has the boundaries first, then everything the
+            // snarl contains outside its children
+            vector<id_t>& nodes = snarl_nodes[number];
+            unordered_map<id_t, int64_t> rank;
+            auto add_node = [&](id_t node_id) {
+                if (!rank.count(node_id)) {
+                    rank[node_id] = nodes.size();
+                    nodes.push_back(node_id);
+                }
+            };
+            add_node(record.start_node);
+            add_node(record.end_node);
+            for (Node* node : snarl_manager.shallow_contents(snarl, graph, false).first) {
+                add_node(node->id());
+            }
+            record.end_rank = rank[record.end_node];
+            int64_t vertexes = 2 * nodes.size();
+            vector<int64_t> lengths(nodes.size());
+            for (size_t k = 0; k < nodes.size(); k++) {
+                lengths[k] = graph.get_node(nodes[k])->sequence().size();
+            }
+
+            // traversals that enter a child, and whether they enter by its start
+            unordered_map<pair<id_t, bool>, pair<int64_t, bool>> child_entries;
+            for (int64_t child : children[number]) {
+                SnarlRecord& child_record = snarl_records[child];
+                child_entries[make_pair(child_record.start_node, (bool) child_record.start_backward)] = make_pair(child, true);
+                child_entries[make_pair(child_record.end_node, (bool) !child_record.end_backward)] = make_pair(child, false);
+                child_record.parent_start_rank = rank[child_record.start_node];
+                child_record.parent_end_rank = rank[child_record.end_node];
+            }
+
+            int64_t start_in = record.start_backward;
+            int64_t start_out = start_in ^ 1;
+            int64_t end_out = 2 * record.end_rank + record.end_backward;
+            int64_t end_in = end_out ^ 1;
+
+            // call visit with each vertex we can go to next within the net
+            // graph, and the bases in between
+            auto for_each_next = [&](int64_t vertex, const function<void(int64_t, int64_t)>& visit) {
+                if (vertex == end_out || vertex == start_out) {
+                    // this leaves the snarl
+                    return;
+                }
+                id_t node_id = nodes[vertex / 2];
+                bool backward = vertex % 2;
+                auto entry = child_entries.find(make_pair(node_id, backward));
+                if (entry != child_entries.end()) {
+                    // skip through the child, by the distances we already know
+                    const SnarlRecord& child_record = snarl_records[entry->second.first];
+                    const vector<int64_t>& child_distances = snarl_boundaries[entry->second.first];
+                    int64_t from = entry->second.second ? 0 : child_distances.size() / 2;
+                    int64_t child_end_out = 2 * child_record.end_rank + child_record.end_backward;
+                    int64_t child_start_out = child_record.start_backward ^ 1;
+                    if (child_distances[from + child_end_out] < UNREACHABLE) {
+                        visit(2 * child_record.parent_end_rank + child_record.end_backward,
+                              child_distances[from + child_end_out]);
+                    }
+                    if (child_distances[from + child_start_out] < UNREACHABLE) {
+                        visit(2 * child_record.parent_start_rank + !child_record.start_backward,
+                              child_distances[from + child_start_out]);
+                    }
+                    return;
+                }
+                for (auto& next : graph.nodes_next(NodeTraversal(graph.get_node(node_id), backward))) {
+                    auto found = rank.find(next.node->id());
+                    if (found != rank.end()) {
+                        visit(2 * found->second + next.backward, 0);
+                    }
+                }
+            };
+
+            // Dijkstra from the end of one vertex to the starts of all the others
+            auto distances_from = [&](int64_t source) {
+                vector<int64_t> distances(vertexes, UNREACHABLE);
+                priority_queue<pair<int64_t, int64_t>, vector<pair<int64_t, int64_t>>,
+                               greater<pair<int64_t, int64_t>>> queue;
+                for_each_next(source, [&](int64_t next, int64_t between) {
+                    queue.emplace(between, next);
+                });
+                while (!queue.empty()) {
+                    int64_t distance = queue.top().first;
+                    int64_t vertex = queue.top().second;
+                    queue.pop();
+                    if (distances[vertex] != UNREACHABLE) {
+                        continue;
+                    }
+                    distances[vertex] = distance;
+                    int64_t past = distance + lengths[vertex / 2];
+                    for_each_next(vertex, [&](int64_t next, int64_t between) {
+                        if (distances[next] == UNREACHABLE) {
+                            queue.emplace(past + between, next);
+                        }
+                    });
+                }
+                return distances;
+            };
+
+            vector<int64_t>& boundary = snarl_boundaries[number];
+            boundary = distances_from(start_in);
+            vector<int64_t> from_end = distances_from(end_in);
+            boundary.insert(boundary.end(), from_end.begin(), from_end.end());
+
+            if (nodes.size() <= max_snarl_nodes) {
+                vector<int64_t>& matrix = snarl_matrices[number];
+                matrix.reserve(vertexes * vertexes);
+                for (int64_t vertex = 0; vertex < vertexes; vertex++) {
+                    vector<int64_t> row = distances_from(vertex);
+                    matrix.insert(matrix.end(), row.begin(), row.end());
+                }
+            }
+        }
+    }
+
+    // Pack the per-snarl results into flat arrays
+    for (int64_t i = 0; i < snarls.size(); i++) {
+        SnarlRecord& record = snarl_records[i];
+        record.nodes_offset = net_nodes.size();
+        record.node_count = snarl_nodes[i].size();
+        net_nodes.insert(net_nodes.end(), snarl_nodes[i].begin(), snarl_nodes[i].end());
+        boundary_distances.insert(boundary_distances.end(), snarl_boundaries[i].begin(), snarl_boundaries[i].end());
+        if (snarl_matrices[i].empty()) {
+            record.matrix_offset = -1;
+        } else {
+            record.matrix_offset = matrices.size();
+            matrices.insert(matrices.end(), snarl_matrices[i].begin(), snarl_matrices[i].end());
+        }
+        vector<id_t>().swap(snarl_nodes[i]);
+        vector<int64_t>().swap(snarl_boundaries[i]);
+        vector<int64_t>().swap(snarl_matrices[i]);
+    }
+
+    // Set up the node table, and record which snarl owns each node
+    min_id = graph.min_node_id();
+    size_t table_size = graph_nodes ? graph.max_node_id() - min_id + 1 : 0;
+    node_home.assign(table_size, 0);
+    node_rank.assign(table_size, 0);
+    node_lengths.assign(table_size, 0);
+    graph.for_each_node([&](Node* node) {
+        node_lengths[node->id() - min_id] = node->sequence().size();
+    });
+    for (int64_t i = 0; i < snarl_records.size(); i++) {
+        const SnarlRecord& record = snarl_records[i];
+        // the boundaries belong to the parent
+        for (int64_t rank = 0; rank < record.node_count; rank++) {
+            id_t node_id = net_nodes[record.nodes_offset + rank];
+            if (node_id != record.start_node && node_id != record.end_node) {
+                node_home[node_id - min_id] = i + 1;
+                node_rank[node_id - min_id] = rank;
+            }
+        }
+    }
+
+    // String the top level snarls we can pass through into chains. A chain
+    // is a series of boundary visits, each snarl taking us from one visit to
+    // the next, either from its start to its end or backward from its end to
+    // its start.
+    auto reverse_visit = [](pair<id_t, bool> visit) {
+        return make_pair(visit.first, !visit.second);
+    };
+    unordered_map<pair<id_t, bool>, int64_t> start_at;
+    unordered_map<pair<id_t, bool>, int64_t> end_at;
+    vector<int64_t> roots;
+    for (int64_t i = 0; i < snarl_records.size(); i++) {
+        const SnarlRecord& record = snarl_records[i];
+        if (record.parent < 0) {
+            roots.push_back(i);
+            int64_t end_out = 2 * record.end_rank + record.end_backward;
+            // a snarl we can't get through ends any chain it is in
+            if (boundary_distances[4 * record.nodes_offset + end_out] < UNREACHABLE) {
+                start_at[make_pair(record.start_node, (bool) record.start_backward)] = i;
+                end_at[make_pair(record.end_node, (bool) record.end_backward)] = i;
+            }
+        }
+    }
+    auto through = [&](int64_t i) {
+        const SnarlRecord& record = snarl_records[i];
+        return boundary_distances[4 * record.nodes_offset + 2 * record.end_rank + record.end_backward];
+    };
+    auto has_hairpin = [&](int64_t i) {
+        const SnarlRecord& record = snarl_records[i];
+        int64_t offset = 4 * record.nodes_offset;
+        int64_t end_out = 2 * record.end_rank + record.end_backward;
+        return boundary_distances[offset + (record.start_backward ^ 1)] < UNREACHABLE
+            || boundary_distances[offset + 2 * record.node_count + end_out] < UNREACHABLE;
+    };
+    // is nothing attached to the given side of a visit?
+    auto side_is_free = [&](pair<id_t, bool> visit, bool right) {
+        return (right != visit.second) ? graph.edges_end(visit.first).empty() : graph.edges_start(visit.first).empty();
+    };
+    vector<uint8_t> chained(snarl_records.size(), false);
+    auto is_boundary = [&](id_t node_id) {
+        return node_home[node_id - min_id] < 0;
+    };
+    auto add_chain = [&](const deque<pair<id_t, bool>>& visits, const deque<int64_t>& links) {
+        int64_t chain = chain_offsets.size();
+        chain_offsets.push_back(boundary_nodes.size());
+        int64_t prefix = 0;
+        bool hairpin_free = true;
+        for (size_t k = 0; k < visits.size(); k++) {
+            int64_t boundary = boundary_nodes.size();
+            boundary_nodes.push_back(visits[k].first);
+            boundary_backward.push_back(visits[k].second);
+            boundary_prefix.push_back(prefix);
+            node_home[visits[k].first - min_id] = -(chain + 1);
+            node_rank[visits[k].first - min_id] = boundary;
+            if (k < links.size()) {
+                prefix += node_lengths[visits[k].first - min_id] + through(links[k]);
+                hairpin_free = hairpin_free && !has_hairpin(links[k]);
+            }
+        }
+        chain_closed.push_back(side_is_free(visits.front(), false) && side_is_free(visits.back(), true));
+        chain_hairpin_free.push_back(hairpin_free);
+    };
+    for (int64_t root : roots) {
+        if (chained[root] || !start_at.count(make_pair(snarl_records[root].start_node,
+                                                       (bool) snarl_records[root].start_backward))) {
+            continue;
+        }
+        const SnarlRecord& record = snarl_records[root];
+        if (record.start_node == record.end_node
+            || is_boundary(record.start_node) || is_boundary(record.end_node)) {
+            continue;
+        }
+        deque<pair<id_t, bool>> visits{make_pair(record.start_node, (bool) record.start_backward),
+                                       make_pair(record.end_node, (bool) record.end_backward)};
+        deque<int64_t> links{root};
+        chained[root] = true;
+        unordered_set<id_t> in_chain{record.start_node, record.end_node};
+        // extend forward from the last visit
+        while (true) {
+            pair<id_t, bool> next_visit;
+            int64_t next = -1;
+            auto found = start_at.find(visits.back());
+            if (found != start_at.end() && !chained[found->second]) {
+                next = found->second;
+                next_visit = make_pair(snarl_records[next].end_node, (bool) snarl_records[next].end_backward);
+            } else {
+                found = end_at.find(reverse_visit(visits.back()));
+                if (found != end_at.end() && !chained[found->second]) {
+                    next = found->second;
+                    next_visit = reverse_visit(make_pair(snarl_records[next].start_node,
+                                                         (bool) snarl_records[next].start_backward));
+                }
+            }
+            // stop before going round a cycle
+            if (next < 0 || in_chain.count(next_visit.first) || is_boundary(next_visit.first)) {
+                break;
+            }
+            chained[next] = true;
+            in_chain.insert(next_visit.first);
+            visits.push_back(next_visit);
+            links.push_back(next);
+        }
+        // and backward from the first
+        while (true) {
+            pair<id_t, bool> prev_visit;
+            int64_t prev = -1;
+            auto found = end_at.find(visits.front());
+            if (found != end_at.end() && !chained[found->second]) {
+                prev = found->second;
+                prev_visit = make_pair(snarl_records[prev].start_node, (bool) snarl_records[prev].start_backward);
+            } else {
+                found = start_at.find(reverse_visit(visits.front()));
+                if (found != start_at.end() && !chained[found->second]) {
+                    prev = found->second;
+                    prev_visit = reverse_visit(make_pair(snarl_records[prev].end_node,
+                                                         (bool) snarl_records[prev].end_backward));
+                }
+            }
+            if (prev < 0 || in_chain.count(prev_visit.first) || is_boundary(prev_visit.first)) {
+                break;
+            }
+            chained[prev] = true;
+            in_chain.insert(prev_visit.first);
+            visits.push_front(prev_visit);
+            links.push_front(prev);
+        }
+        add_chain(visits, links);
+    }
+    // boundaries of top level snarls that didn't make it into a chain get
+    // chains of their own
+    for (int64_t root : roots) {
+        const SnarlRecord& record = snarl_records[root];
+        for (auto visit : {make_pair(record.start_node, (bool) record.start_backward),
+                           make_pair(record.end_node, (bool) record.end_backward)}) {
+            if (!is_boundary(visit.first)) {
+                add_chain(deque<pair<id_t, bool>>{visit}, deque<int64_t>());
+            }
+        }
+    }
+    chain_offsets.push_back(boundary_nodes.size());
+
+    // now tell the top level snarls where their boundaries are
+    for (int64_t root : roots) {
+        SnarlRecord& record = snarl_records[root];
+        record.parent_start_rank = node_rank[record.start_node - min_id];
+        record.parent_end_rank = node_rank[record.end_node - min_id];
+    }
+}
+
+void DistanceIndex::load(istream& in) {
+    string magic(4, ' ');
+    in.read(&magic[0], 4);
+    if (!in || magic != "DST2") {
+        throw runtime_error("DistanceIndex: input is not a distance index");
+    }
+    in.read((char*) &graph_nodes, sizeof(graph_nodes));
+    in.read((char*) &graph_length, sizeof(graph_length));
+    in.read((char*) &graph_edges, sizeof(graph_edges));
+    in.read((char*) &graph_hash, sizeof(graph_hash));
+    in.read((char*) &min_id, sizeof(min_id));
+    read_vector(in, snarl_records);
+    read_vector(in, net_nodes);
+    read_vector(in, boundary_distances);
+    read_vector(in, matrices);
+    read_vector(in, chain_offsets);
+    read_vector(in, chain_closed);
+    read_vector(in, chain_hairpin_free);
+    read_vector(in, boundary_nodes);
+    read_vector(in, boundary_backward);
+    read_vector(in, boundary_prefix);
+    read_vector(in, node_home);
+    read_vector(in, node_rank);
+    read_vector(in, node_lengths);
+    if (!in) {
+        throw runtime_error("DistanceIndex: truncated distance index");
+    }
+}
+
+void DistanceIndex::serialize(ostream& out) const {
+    out.write("DST2", 4);
+    out.write((const char*) &graph_nodes, sizeof(graph_nodes));
+    out.write((const char*) &graph_length, sizeof(graph_length));
+    out.write((const char*) &graph_edges, sizeof(graph_edges));
+    out.write((const char*) &graph_hash, sizeof(graph_hash));
+    out.write((const char*) &min_id, sizeof(min_id));
+    write_vector(out, snarl_records);
+    write_vector(out, net_nodes);
+    write_vector(out, boundary_distances);
+    write_vector(out, matrices);
+    write_vector(out, chain_offsets);
+    write_vector(out, chain_closed);
+    write_vector(out, chain_hairpin_free);
+    write_vector(out, boundary_nodes);
+    write_vector(out, boundary_backward);
+    write_vector(out, boundary_prefix);
+    write_vector(out, node_home);
+    write_vector(out, node_rank);
+    write_vector(out, node_lengths);
+}
+
+bool DistanceIndex::matches(const xg::XG& xg_index) const {
+    if (graph_nodes != xg_index.node_count || graph_length != xg_index.seq_length
+        || graph_edges != xg_index.edge_count) {
+        return false;
+    }
+    
+    // Recompute the fingerprint from the xg index
+    uint64_t hash = 0;
+    for (size_t rank = 1; rank <= xg_index.node_count; rank++) {
+        id_t node_id = xg_index.rank_to_id(rank);
+        hash += node_hash(node_id, xg_index.node_length(node_id));
+        // Each edge is listed on both of its nodes, so count it only on the
+        // one with the lower ID, and only once if it joins a node to itself
+        vector<uint64_t> self_loops;
+        for (auto& edge : xg_index.edges_of(node_id)) {
+            if (min(edge.from(), edge.to()) != node_id) {
+                continue;
+            }
+            if (edge.from() == edge.to()) {
+                self_loops.push_back(edge_hash(edge));
+            } else {
+                hash += edge_hash(edge);
+            }
+        }
+        sort(self_loops.begin(), self_loops.end());
+        self_loops.erase(unique(self_loops.begin(), self_loops.end()), self_loops.end());
+        for (uint64_t loop_hash : self_loops) {
+            hash += loop_hash;
+        }
+    }
+    return hash == graph_hash;
+}
+
+inline int64_t DistanceIndex::node_length(id_t node_id) const {
+    return node_lengths[node_id - min_id];
+}
+
+int64_t DistanceIndex::chain_of(int64_t boundary) const {
+    return upper_bound(chain_offsets.begin(), chain_offsets.end(), boundary) - chain_offsets.begin() - 1;
+}
+
+int64_t DistanceIndex::net_distance(const SnarlRecord& snarl, int64_t from, int64_t to) const {
+    int64_t vertexes = 2 * snarl.node_count;
+    if (snarl.matrix_offset >= 0) {
+        return matrices[snarl.matrix_offset + from * vertexes + to];
+    }
+    const int64_t* from_start = &boundary_distances[4 * snarl.nodes_offset];
+    const int64_t* from_end = from_start + vertexes;
+    int64_t start_in = snarl.start_backward;
+    int64_t end_in = (2 * snarl.end_rank + snarl.end_backward) ^ 1;
+    if (from == start_in) {
+        return from_start[to];
+    } else if (from == end_in) {
+        return from_end[to];
+    } else if (to == (end_in ^ 1)) {
+        // going to the end is coming back from the end on the other strand
+        return from_end[from ^ 1];
+    } else if (to == (start_in ^ 1)) {
+        return from_start[from ^ 1];
+    }
+    return -1;
+}
+
+void DistanceIndex::climb(int64_t snarl_number, vector<Endpoint>& endpoints, bool sources) const {
+    const SnarlRecord& snarl = snarl_records[snarl_number];
+    bool top_level = snarl.parent < 0;
+    // where a boundary visit lands in the parent's net graph, or along the chains
+    auto parent_vertex = [&](int64_t parent_rank, bool backward) {
+        if (top_level) {
+            backward = backward != (bool) boundary_backward[parent_rank];
+        }
+        return 2 * parent_rank + backward;
+    };
+    int64_t start_in = snarl.start_backward;
+    int64_t end_out = 2 * snarl.end_rank + snarl.end_backward;
+    // sources leave through the end or back out the start, and targets are
+    // entered through the start or back in the end
+    int64_t gates[2];
+    int64_t gate_vertexes[2];
+    id_t gate_nodes[2] = {snarl.start_node, snarl.end_node};
+    if (sources) {
+        gates[0] = start_in ^ 1;
+        gate_vertexes[0] = parent_vertex(snarl.parent_start_rank, !snarl.start_backward);
+        gates[1] = end_out;
+        gate_vertexes[1] = parent_vertex(snarl.parent_end_rank, snarl.end_backward);
+    } else {
+        gates[0] = start_in;
+        gate_vertexes[0] = parent_vertex(snarl.parent_start_rank, snarl.start_backward);
+        gates[1] = end_out ^ 1;
+        gate_vertexes[1] = parent_vertex(snarl.parent_end_rank, !snarl.end_backward);
+    }
+
+    vector<Endpoint> climbed;
+    for (size_t i = 0; i < 2; i++) {
+        int64_t gate_length = node_length(gate_nodes[i]);
+        int64_t best = UNREACHABLE;
+        for (auto& endpoint : endpoints) {
+            if (endpoint.vertex == gates[i] && !endpoint.original) {
+                best = min(best, endpoint.distance);
+                continue;
+            }
+            int64_t between = sources ? net_distance(snarl, endpoint.vertex, gates[i])
+                                      : net_distance(snarl, gates[i], endpoint.vertex);
+            if (between >= 0 && between < UNREACHABLE) {
+                best = min(best, endpoint.distance + between + gate_length);
+            }
+        }
+        if (best < UNREACHABLE) {
+            climbed.push_back(Endpoint{gate_vertexes[i], best, false});
+        }
+    }
+    endpoints = std::move(climbed);
+}
+
+void DistanceIndex::combine_in_snarl(int64_t snarl_number, const vector<Endpoint>& sources,
+                                     const vector<Endpoint>& targets, int64_t& best, bool& unknown) const {
+    const SnarlRecord& snarl = snarl_records[snarl_number];
+    for (auto& source : sources) {
+        for (auto& target : targets) {
+            if (source.vertex == target.vertex && !(source.original && target.original)) {
+                // they meet on this vertex
+                id_t node_id = net_nodes[snarl.nodes_offset + source.vertex / 2];
+                best = min(best, source.distance + target.distance - node_length(node_id));
+            }
+            int64_t between = net_distance(snarl, source.vertex, target.vertex);
+            if (between < 0) {
+                unknown = true;
+            } else if (between < UNREACHABLE) {
+                best = min(best, source.distance + between + target.distance);
+            }
+        }
+    }
+}
+
+void DistanceIndex::combine_in_chains(const vector<Endpoint>& sources, const vector<Endpoint>& targets,
+                                      int64_t& best, bool& unknown) const {
+    // the least a path that leaves the chains and comes back in could be
+    int64_t bound = UNREACHABLE;
+    auto chain_length = [&](int64_t chain) {
+        int64_t last = chain_offsets[chain + 1] - 1;
+        return boundary_prefix[last] + node_length(boundary_nodes[last]);
+    };
+    for (auto& source : sources) {
+        int64_t from = source.vertex / 2;
+        bool from_reverse = source.vertex % 2;
+        int64_t from_chain = chain_of(from);
+        int64_t from_length = node_length(boundary_nodes[from]);
+        for (auto& target : targets) {
+            int64_t to = target.vertex / 2;
+            bool to_reverse = target.vertex % 2;
+            int64_t to_chain = chain_of(to);
+            int64_t to_length = node_length(boundary_nodes[to]);
+            if (source.vertex == target.vertex && !(source.original && target.original)) {
+                best = min(best, source.distance + target.distance - from_length);
+            }
+            if (from_chain == to_chain && from_reverse == to_reverse
+                && (from_reverse ? to < from : to > from)) {
+                // straight along the chain
+                int64_t between = from_reverse ? boundary_prefix[from] - boundary_prefix[to] - to_length
+                                               : boundary_prefix[to] - boundary_prefix[from] - from_length;
+                best = min(best, source.distance + between + target.distance);
+                if (!chain_hairpin_free[from_chain] && !chain_closed[from_chain]) {
+                    // we could turn around outside the chain and come back
+                    // in on a shortcut
+                    unknown = true;
+                }
+            } else if (!chain_hairpin_free[from_chain] || !chain_hairpin_free[to_chain]) {
+                // we can't tell how to turn around
+                unknown = true;
+            } else if (!chain_closed[from_chain] && !chain_closed[to_chain]) {
+                // we have to go out the end we are heading for, and in the
+                // end that leads to the target
+                int64_t out = from_reverse ? boundary_prefix[from]
+                                           : chain_length(from_chain) - boundary_prefix[from] - from_length;
+                int64_t in = to_reverse ? chain_length(to_chain) - boundary_prefix[to] - to_length
+                                        : boundary_prefix[to];
+                bound = min(bound, source.distance + out + in + target.distance);
+            }
+        }
+    }
+    if (bound < best) {
+        unknown = true;
+    }
+}
+
+bool DistanceIndex::min_distance(pos_t pos1, pos_t pos2, int64_t& distance) const {
+    auto indexed = [&](id_t node_id) {
+        return node_id >= min_id && node_id - min_id < node_home.size() && node_home[node_id - min_id] != 0;
+    };
+    if (!indexed(id(pos1)) || !indexed(id(pos2))) {
+        return false;
+    }
+    if (id(pos1) == id(pos2) && is_rev(pos1) == is_rev(pos2) && offset(pos2) >= offset(pos1)) {
+        distance = offset(pos2) - offset(pos1);
+        return true;
+    }
+
+    // find each node's vertex in the net graph of the snarl that owns it, or
+    // along the chains
+    auto place = [&](pos_t pos, int64_t& level) {
+        int32_t home = node_home[id(pos) - min_id];
+        int64_t rank = node_rank[id(pos) - min_id];
+        bool backward = is_rev(pos);
+        if (home > 0) {
+            level = home - 1;
+        } else {
+            level = -1;
+            backward = backward != (bool) boundary_backward[rank];
+        }
+        return vector<Endpoint>{Endpoint{2 * rank + backward, 0, true}};
+    };
+    auto depth = [&](int64_t level) {
+        return level < 0 ? -1 : snarl_records[level].depth;
+    };
+    int64_t source_level, target_level;
+    vector<Endpoint> sources = place(pos1, source_level);
+    vector<Endpoint> targets = place(pos2, target_level);
+
+    // climb to the lowest snarl holding both
+    while (source_level != target_level) {
+        if (depth(source_level) >= depth(target_level)) {
+            climb(source_level, sources, true);
+            source_level = snarl_records[source_level].parent;
+        } else {
+            climb(target_level, targets, false);
+            target_level = snarl_records[target_level].parent;
+        }
+        if (sources.empty() || targets.empty()) {
+            // one can't get out of a snarl the other isn't in
+            distance = -1;
+            return true;
+        }
+    }
+
+    // then keep climbing, in case the shortest path leaves that snarl and
+    // comes back, until nothing shorter could be found further up
+    int64_t best = UNREACHABLE;
+    bool unknown = false;
+    int64_t level = source_level;
+    while (true) {
+        if (level < 0) {
+            combine_in_chains(sources, targets, best, unknown);
+            break;
+        }
+        combine_in_snarl(level, sources, targets, best, unknown);
+        if (unknown) {
+            return false;
+        }
+        climb(level, sources, true);
+        climb(level, targets, false);
+        level = snarl_records[level].parent;
+        if (sources.empty() || targets.empty()) {
+            break;
+        }
+        int64_t least_out = UNREACHABLE;
+        int64_t least_in = UNREACHABLE;
+        for (auto& source : sources) {
+            id_t node_id = level < 0 ? boundary_nodes[source.vertex / 2]
+                                     : net_nodes[snarl_records[level].nodes_offset + source.vertex / 2];
+            least_out = min(least_out, source.distance - node_length(node_id));
+        }
+        for (auto& target : targets) {
+            id_t node_id = level < 0 ? boundary_nodes[target.vertex / 2]
+                                     : net_nodes[snarl_records[level].nodes_offset + target.vertex / 2];
+            least_in = min(least_in, target.distance - node_length(node_id));
+        }
+        if (best <= least_out + least_in) {
+            break;
+        }
+    }
+    if (unknown) {
+        return false;
+    }
+
+    distance = best < UNREACHABLE ? node_length(id(pos1)) - offset(pos1) + best + offset(pos2) : -1;
+    return true;
+}
+
+}
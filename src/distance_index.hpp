@@ -0,0 +1,182 @@
+#ifndef VG_DISTANCE_INDEX_H
+#define VG_DISTANCE_INDEX_H
+/// \file distance_index.hpp
+/// Defines the DistanceIndex, which precomputes minimum distances over the
+/// snarl decomposition of a graph so that distance queries between positions
+/// don't need to search the graph.
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "vg.hpp"
+#include "snarls.hpp"
+#include "position.hpp"
+#include "xg.hpp"
+
+namespace vg {
+
+using namespace std;
+
+/**
+ * Index of minimum distances over a snarl tree. Every snarl keeps the
+ * distances within its net graph (its own nodes, with child snarls collapsed
+ * into their minimum traversals), and the top level snarls are strung into
+ * chains that keep prefix sums of the distances along them. A query climbs the
+ * snarl tree from both positions, so it takes time proportional to the depth
+ * of the positions in the tree.
+ *
+ * Snarls with very large net graphs don't get a full distance matrix, and
+ * positions outside the chains aren't indexed. Queries the index can't answer
+ * exactly in those cases are reported as such, so the caller can fall back to
+ * searching the graph.
+ */
+class DistanceIndex {
+public:
+
+    /// Indexes are saved beside their xg index with this extension
+    static const string EXTENSION;
+
+    /// Make an empty index, to load into
+    DistanceIndex(void) = default;
+
+    /// Index the given graph using its snarl decomposition. Snarls of the
+    /// same depth are processed in parallel. Snarls whose net graphs have more
+    /// than max_snarl_nodes nodes don't get a full distance matrix.
+    DistanceIndex(VG& graph, SnarlManager& snarl_manager, size_t max_snarl_nodes = 256);
+
+    /// Load an index from a stream. Throws runtime_error if it isn't an index.
+    void load(istream& in);
+    /// Save the index to a stream.
+    void serialize(ostream& out) const;
+
+    /// Returns true if the index was built from the graph in this xg index, as
+    /// far as its node and edge counts, sequence length and a hash of all its
+    /// nodes (IDs and lengths) and edges can tell. Takes time linear in the
+    /// size of the graph.
+    bool matches(const xg::XG& xg_index) const;
+
+    /// Find the minimum number of bases stepped walking forward from pos1 to
+    /// pos2, as xg_cached_distance() counts them. Returns false if the index
+    /// can't answer exactly. Otherwise returns true and sets distance, to -1
+    /// if pos2 can't be reached from pos1.
+    bool min_distance(pos_t pos1, pos_t pos2, int64_t& distance) const;
+
+private:
+
+    /// Distance for vertexes that can't be reached from each other
+    static const int64_t UNREACHABLE;
+
+    /// Everything about a snarl that queries need, as fixed-size numbers so
+    /// the records can be saved as they are. Vertexes of a net graph are
+    /// numbered 2 * rank + is_reverse, where rank is a node's number in the
+    /// net graph, and the snarl's start node always has rank 0.
+    struct SnarlRecord {
+        int64_t start_node;
+        int64_t start_backward;
+        int64_t end_node;
+        int64_t end_backward;
+        /// Rank of the end node in this snarl's net graph
+        int64_t end_rank;
+        /// Number of the parent snarl, or -1 for a top level snarl
+        int64_t parent;
+        int64_t depth;
+        /// Ranks of the start and end nodes in the parent's net graph, or for
+        /// a top level snarl their overall chain boundary numbers
+        int64_t parent_start_rank;
+        int64_t parent_end_rank;
+        /// Where the net graph's nodes start in net_nodes, and how many it has
+        int64_t nodes_offset;
+        int64_t node_count;
+        /// Where the full distance matrix starts in matrices, or -1 if there is
+        /// none
+        int64_t matrix_offset;
+    };
+
+    /// A vertex we have found the distance to while climbing the snarl tree.
+    /// At the top level, vertexes are numbered 2 * boundary + is_reverse,
+    /// where boundary is a chain boundary's overall number and is_reverse is
+    /// relative to the chain.
+    struct Endpoint {
+        int64_t vertex;
+        /// Distance from the end of the query's first node to the end of this
+        /// vertex (for a source), or from the start of this vertex to the
+        /// start of the query's second node (for a target)
+        int64_t distance;
+        /// True if this is the query's node itself
+        bool original;
+    };
+
+    /// Distance within a snarl's net graph from the end of one vertex to the
+    /// start of another, or UNREACHABLE. If the snarl has no matrix, only
+    /// distances from the start and the reverse of the end are available, and
+    /// others come back as -1.
+    int64_t net_distance(const SnarlRecord& snarl, int64_t from, int64_t to) const;
+
+    /// Move sources (or targets) from the given snarl's net graph to its
+    /// parent's, through the snarl's exits (or entrances).
+    void climb(int64_t snarl_number, vector<Endpoint>& endpoints, bool sources) const;
+
+    /// Find the shortest way from the sources to the targets within a snarl.
+    /// Sets unknown if the snarl can't answer.
+    void combine_in_snarl(int64_t snarl_number, const vector<Endpoint>& sources,
+                          const vector<Endpoint>& targets, int64_t& best, bool& unknown) const;
+
+    /// Find the shortest way from the sources to the targets along the top
+    /// level chains. Sets unknown if a path could leave the chains and come
+    /// back shorter than the best one found.
+    void combine_in_chains(const vector<Endpoint>& sources, const vector<Endpoint>& targets,
+                           int64_t& best, bool& unknown) const;
+
+    /// Get the chain a top level boundary belongs to.
+    int64_t chain_of(int64_t boundary) const;
+
+    /// Get the length of a node, which must be in the index.
+    inline int64_t node_length(id_t node_id) const;
+
+    vector<SnarlRecord> snarl_records;
+    /// The nodes of each snarl's net graph, in rank order
+    vector<id_t> net_nodes;
+    /// For each snarl, distances from the start and from the reverse of the
+    /// end to each net graph vertex, stored at 4 * nodes_offset
+    vector<int64_t> boundary_distances;
+    /// Full net graph distance matrices, by row
+    vector<int64_t> matrices;
+
+    /// Where each chain's boundaries start, with an extra entry at the end
+    vector<int64_t> chain_offsets;
+    /// For each chain, whether nothing attaches to the outer sides of its ends
+    vector<uint8_t> chain_closed;
+    /// For each chain, whether none of its snarls can be entered and left on
+    /// the same side
+    vector<uint8_t> chain_hairpin_free;
+    /// The nodes at the boundaries of the chains, in chain order
+    vector<id_t> boundary_nodes;
+    /// The orientation of each boundary node along its chain
+    vector<uint8_t> boundary_backward;
+    /// The distance along the chain from the start of its first boundary to
+    /// the start of each boundary
+    vector<int64_t> boundary_prefix;
+
+    /// Node table, indexed by node ID - min_id
+    id_t min_id = 0;
+    /// For each node, the number of its innermost snarl + 1, or -(number of
+    /// its chain + 1) if it is a top level chain boundary, or 0 if it is not
+    /// indexed
+    vector<int32_t> node_home;
+    /// For each node, its rank in its snarl's net graph, or its overall
+    /// boundary number
+    vector<uint32_t> node_rank;
+    vector<uint32_t> node_lengths;
+
+    /// Size of the graph the index was built from
+    size_t graph_nodes = 0;
+    size_t graph_length = 0;
+    size_t graph_edges = 0;
+    /// Sum of the hashes of all the graph's nodes and edges
+    uint64_t graph_hash = 0;
+};
+
+}
+
+#endif
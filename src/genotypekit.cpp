@@ -347,12 +347,62 @@ vector<SnarlTraversal> PathBasedTraversalFinder::find_traversals(const Snarl& si
 
 SnarlManager CactusUltrabubbleFinder::find_snarls() {
     
-    // Get the bubble tree in Cactus format
-    BubbleTree* bubble_tree = ultrabubble_tree(graph);
+    // Snarls never span connected components, so we can decompose each
+    // component with its own Cactus graph, in parallel.
+    vector<set<Node*>> component_nodes;
+    unordered_set<Node*> assigned;
+    graph.for_each_node([&](Node* node) {
+        if (!assigned.count(node)) {
+            component_nodes.emplace_back();
+            graph.collect_subgraph(node, component_nodes.back());
+            assigned.insert(component_nodes.back().begin(), component_nodes.back().end());
+        }
+    });
     
-    // Convert to Snarls
+    if (component_nodes.size() <= 1) {
+        // Don't bother copying the graph if there's only one component
+        vector<Snarl> converted_snarls;
+        find_component_snarls(graph, converted_snarls);
+        return SnarlManager(converted_snarls.begin(), converted_snarls.end());
+    }
+    
+#ifdef debug
+    cerr << "Finding snarls in " << component_nodes.size() << " connected components" << endl;
+#endif
+    
+    // Do the biggest components first so the small ones fill in the gaps
+    sort(component_nodes.begin(), component_nodes.end(), [](const set<Node*>& a, const set<Node*>& b) {
+        return a.size() > b.size();
+    });
+    
+    vector<vector<Snarl>> component_snarls(component_nodes.size());
     
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < component_nodes.size(); i++) {
+        // Copy out the component as its own graph (which the constructor
+        // sorts, as Cactus needs to find a source and sink)
+        set<Edge*> component_edges;
+        graph.edges_of_nodes(component_nodes[i], component_edges);
+        VG component(component_nodes[i], component_edges);
+        
+        find_component_snarls(component, component_snarls[i]);
+    }
+    
+    // Merge the results into one SnarlManager
     vector<Snarl> converted_snarls;
+    for (auto& snarls : component_snarls) {
+        std::move(snarls.begin(), snarls.end(), back_inserter(converted_snarls));
+    }
+    
+    return SnarlManager(converted_snarls.begin(), converted_snarls.end());
+}
+
+void CactusUltrabubbleFinder::find_component_snarls(VG& component, vector<Snarl>& converted_snarls) {
+    
+    // Get the bubble tree in Cactus format
+    BubbleTree* bubble_tree = ultrabubble_tree(component);
+    
+    // Convert to Snarls
     
     bubble_tree->for_each_preorder([&](BubbleTree::Node* node) {
         
@@ -364,8 +414,8 @@ SnarlManager CactusUltrabubbleFinder::find_snarls() {
                 
                 // Check whether the bubble consists of a single edge
                 
-                set<NodeSide> start_connections = graph.sides_of(bubble.start);
-                set<NodeSide> end_connections = graph.sides_of(bubble.end);
+                set<NodeSide> start_connections = component.sides_of(bubble.start);
+                set<NodeSide> end_connections = component.sides_of(bubble.end);
                 
                 if (start_connections.size() == 1
                     && start_connections.count(bubble.end)
@@ -408,9 +458,6 @@ SnarlManager CactusUltrabubbleFinder::find_snarls() {
     });
     
     delete bubble_tree;
-    
-    // Now form the SnarlManager and return
-    return SnarlManager(converted_snarls.begin(), converted_snarls.end());
 }
     
    
@@ -477,17 +524,20 @@ vector<SnarlTraversal> ExhaustiveTraversalFinder::find_traversals(const Snarl& s
     vector<SnarlTraversal> to_return;
     
     // construct maps that lets us "skip over" child sites
-    map<NodeTraversal, const Snarl*> child_site_starts;
-    map<NodeTraversal, const Snarl*> child_site_ends;
-    for (const Snarl* subsite : snarl_manager.children_of(&site)) {
-        child_site_starts[to_node_traversal(subsite->start(), graph)] = subsite;
+    const vector<const Snarl*>& children = snarl_manager.children_of(&site);
+    map<NodeTraversal, size_t> child_site_starts;
+    map<NodeTraversal, size_t> child_site_ends;
+    for (size_t i = 0; i < children.size(); i++) {
+        child_site_starts[to_node_traversal(children[i]->start(), graph)] = i;
         // reverse the direction of the end because we want to find it when we're entering
         // the site from that direction
-        child_site_ends[to_rev_node_traversal(subsite->end(), graph)] = subsite;
+        child_site_ends[to_rev_node_traversal(children[i]->end(), graph)] = i;
     }
     
-    // keeps track of the walk of the DFS traversal
-    list<Visit> path;
+    // keeps track of the walk of the DFS traversal, as packed visits: node
+    // visits are stored as (id << 1 | backward), and child snarl visits as
+    // the negative value -((child number << 1 | backward) + 1)
+    vector<int64_t> path;
     
     // these mark the start of the edges out of the node that is on the head of the path
     // they can be used to see how many nodes we need to peel off the path when we're
@@ -514,20 +564,27 @@ vector<SnarlTraversal> ExhaustiveTraversalFinder::find_traversals(const Snarl& s
         if (node_traversal == site_end) {
             
             // yield path as a snarl traversal
-            SnarlTraversal traversal;
-            to_return.push_back(traversal);
-            
-            // increment past the Snarl's start node, which we don't want in the traversal
-            auto iter = path.begin();
-            iter++;
-            // record the traversal in the return value
-            for (; iter != path.end(); iter++) {
-                *to_return.back().add_visits() = *iter;
+            to_return.emplace_back();
+            SnarlTraversal& traversal = to_return.back();
+            
+            // skip the Snarl's start node, which we don't want in the traversal,
+            // and unpack the rest into Visits
+            for (size_t i = 1; i < path.size(); i++) {
+                Visit* visit = traversal.add_visits();
+                if (path[i] >= 0) {
+                    visit->set_node_id(path[i] >> 1);
+                    visit->set_backward(path[i] & 1);
+                }
+                else {
+                    int64_t packed_child = -(path[i] + 1);
+                    transfer_boundary_info(*children[packed_child >> 1], *visit->mutable_snarl());
+                    visit->set_backward(packed_child & 1);
+                }
             }
             
             // label which snarl this came from
-            *to_return.back().mutable_snarl()->mutable_start() = site.start();
-            *to_return.back().mutable_snarl()->mutable_end() = site.end();
+            *traversal.mutable_snarl()->mutable_start() = site.start();
+            *traversal.mutable_snarl()->mutable_end() = site.end();
             
             // don't proceed to add more onto the DFS stack
             continue;
@@ -536,41 +593,33 @@ vector<SnarlTraversal> ExhaustiveTraversalFinder::find_traversals(const Snarl& s
         // mark the beginning of this node/site's edges forward in the stack
         stack.push_back(stack_sentinel);
         
-        // initialize empty visit for this iteration
-        Visit visit;
+        auto child_start = child_site_starts.find(node_traversal);
+        auto child_end = child_site_ends.find(node_traversal);
         
-        if (child_site_starts.count(node_traversal)) {
+        if (child_start != child_site_starts.end()) {
             // make a visit out of the site
-            const Snarl* child_site = child_site_starts[node_traversal];
-            transfer_boundary_info(*child_site, *visit.mutable_snarl());
-            visit.set_backward(false);
+            path.push_back(-((int64_t) (child_start->second << 1) + 1));
             
             // skip the site and add the other side to the stack
-            stack.push_back(to_node_traversal(child_site->end(), graph));
+            stack.push_back(to_node_traversal(children[child_start->second]->end(), graph));
         }
-        else if (child_site_ends.count(node_traversal)) {
-            // make a visit out of the site
-            const Snarl* child_site = child_site_ends[node_traversal];
-            transfer_boundary_info(*child_site, *visit.mutable_snarl());
-            visit.set_backward(true);
+        else if (child_end != child_site_ends.end()) {
+            // make a backward visit out of the site
+            path.push_back(-((int64_t) (child_end->second << 1 | 1) + 1));
             
             // note: we're traveling through the site backwards, so we reverse the
             // traversal on the start end
             
             // skip the site and add the other side to the stack
-            stack.push_back(to_rev_node_traversal(child_site->start(), graph));
+            stack.push_back(to_rev_node_traversal(children[child_end->second]->start(), graph));
         }
         else {
             // make a visit out of the node traversal
-            visit.set_node_id(node_traversal.node->id());
-            visit.set_backward(node_traversal.backward);
+            path.push_back(node_traversal.node->id() << 1 | (int64_t) node_traversal.backward);
             
             // add all of the node traversals we can reach through valid walks to stack
             stack_up_valid_walks(node_traversal, stack);
         }
-        
-        // add visit to path
-        path.push_back(visit);
     }
     
     return to_return;
@@ -1057,14 +1106,14 @@ vector<SnarlTraversal> RepresentativeTraversalFinder::find_traversals(const Snar
     while(ref_node_start <= primary_max) {
     
         // Find the reference node starting here or later.
-        auto found = index.by_start.lower_bound(ref_node_start);
-        if(found == index.by_start.end()) {
+        size_t found = index.next_occurrence(ref_node_start);
+        if(found == index.occurrence_count()) {
             throw runtime_error("No backbone node found when tracing through site!");
         }
 #ifdef debug
-        cerr << "Ref node: " << found->second << " at " << ref_node_start << "/" << primary_max << endl;
+        cerr << "Ref node: " << index.occurrence_side(found) << " at " << ref_node_start << "/" << primary_max << endl;
 #endif
-        if((*found).first > primary_max) {
+        if(index.occurrence_start(found) > primary_max) {
             // The next reference node we can find is out of the space
             // being replaced. We're done.
             if (verbose) {
@@ -1074,7 +1123,7 @@ vector<SnarlTraversal> RepresentativeTraversalFinder::find_traversals(const Snar
         }
         
         // Get the corresponding Visit
-        Visit found_visit = found->second.to_visit();
+        Visit found_visit = index.occurrence_side(found).to_visit();
         
         // What node did we hit?
         Node* visited_node = augmented.graph.get_node(found_visit.node_id());
@@ -1102,12 +1151,12 @@ vector<SnarlTraversal> RepresentativeTraversalFinder::find_traversals(const Snar
             Node* here = visited_node;
             do {
                 // Advance
-                ref_node_start = found->first + here->sequence().size();
+                ref_node_start = index.occurrence_start(found) + here->sequence().size();
                 // And look at what we get
-                found = index.by_start.lower_bound(ref_node_start);
-                assert(found != index.by_start.end());
+                found = index.next_occurrence(ref_node_start);
+                assert(found != index.occurrence_count());
                 // And grab out the node
-                found_visit = found->second.to_visit();
+                found_visit = index.occurrence_side(found).to_visit();
                 here = augmented.graph.get_node(found_visit.node_id());
                 // Until we find something in this parent again that isn't the
                 // closing visit of a child snarl. We'll look at what we find
@@ -1119,10 +1168,10 @@ vector<SnarlTraversal> RepresentativeTraversalFinder::find_traversals(const Snar
                 
                 if (!child_boundary_index.count(to_node_traversal(found_visit, augmented.graph))) {
                     // We don't have another child snarl immediately. Look at the node after this one.
-                    ref_node_start = found->first + here->sequence().size();
-                    found = index.by_start.lower_bound(ref_node_start);
-                    assert(found != index.by_start.end());
-                    found_visit = found->second.to_visit();
+                    ref_node_start = index.occurrence_start(found) + here->sequence().size();
+                    found = index.next_occurrence(ref_node_start);
+                    assert(found != index.occurrence_count());
+                    found_visit = index.occurrence_side(found).to_visit();
                     here = augmented.graph.get_node(found_visit.node_id());
                 } else {
                     // It's also the start node of another child snarl, so loop
@@ -1150,7 +1199,7 @@ vector<SnarlTraversal> RepresentativeTraversalFinder::find_traversals(const Snar
             
             
             // Next iteration look where this node ends.
-            ref_node_start = found->first + visited_node->sequence().size();
+            ref_node_start = index.occurrence_start(found) + visited_node->sequence().size();
         }
         
 #ifdef debug
@@ -1840,16 +1889,42 @@ set<pair<size_t, list<Visit>>> RepresentativeTraversalFinder::bfs_left(Visit vis
     
     // Do a BFS
     
-    // This holds the paths to get to NodeTraversals to visit (all of which will
-    // end with the node we're starting with).
-    list<list<Visit>> toExtend;
+    // Partial paths share their tails, so we keep them as a tree: each entry
+    // holds a visit, the index of the entry for the visit to its right (the
+    // next one towards the visit we started with), and how many visits long
+    // the path from it is. Paths are only built out when they are emitted.
+    struct SearchStep {
+        Visit visit;
+        size_t next;
+        size_t depth;
+    };
+    vector<SearchStep> steps;
+    
+    // Turn the path ending at a step into a list of visits.
+    auto trace_path = [&](size_t step) -> list<Visit> {
+        list<Visit> path;
+        while (true) {
+            path.push_back(steps[step].visit);
+            if (steps[step].next == step) {
+                // This is the visit we started with
+                break;
+            }
+            step = steps[step].next;
+        }
+        return path;
+    };
+    
+    // This holds the steps at the heads of the paths to get to NodeTraversals
+    // to visit (all of which will end with the node we're starting with).
+    list<size_t> toExtend;
     
     // This keeps a set of all the oriented nodes we already got to and don't
     // need to queue again.
     set<Visit> alreadyQueued;
     
     // Start at this node at depth 0
-    toExtend.emplace_back(list<Visit> {visit});
+    steps.push_back(SearchStep{visit, 0, 1});
+    toExtend.push_back(0);
     // Mark this traversal as already queued
     alreadyQueued.insert(visit);
     
@@ -1876,61 +1951,68 @@ set<pair<size_t, list<Visit>>> RepresentativeTraversalFinder::bfs_left(Visit vis
 
         
         // Dequeue a path to extend.
-        // Make sure to move out of the list to avoid a useless copy.
-        list<Visit> path(move(toExtend.front()));
+        size_t head = toExtend.front();
         toExtend.pop_front();
         stillToExtend--;
         
+        // Copy out the visit at the front of the path, since steps may
+        // reallocate as we extend.
+        Visit front = steps[head].visit;
+        size_t depth = steps[head].depth;
+        
         // We can't just throw out longer paths, because shorter paths may need
         // to visit a node twice (in opposite orientations) and thus might get
         // rejected later. Or they might overlap with paths on the other side.
         
         // Look up and see if the front node on the path is on our reference
         // path
-        if (path.front().node_id() != 0 && index.by_id.count(path.front().node_id())) {
+        if (front.node_id() != 0 && index.by_id.count(front.node_id())) {
             // This visit is to a node, which is on the reference path.
             
 #ifdef debug
-            cerr << "Reached anchoring node " << path.front().node_id() << endl;
-            cerr << "Emit path of length " << path.size() << endl;
+            cerr << "Reached anchoring node " << front.node_id() << endl;
+            cerr << "Emit path of length " << depth << endl;
 #endif
             
             // Say we got to the right place
+            list<Visit> path = trace_path(head);
             toReturn.emplace(bp_length(path), move(path));
             
             // Don't bother looking for extensions, we already got there.
-        } else if (path.front().node_id() == 0 && !path.front().backward() &&
-            index.by_id.count(path.front().snarl().start().node_id())) {
+        } else if (front.node_id() == 0 && !front.backward() &&
+            index.by_id.count(front.snarl().start().node_id())) {
             // This visit is to a snarl, which is on the reference path on its
             // left end.
             
 #ifdef debug
-            cerr << "Reached start of anchoring snarl " << path.front().snarl() << endl;
+            cerr << "Reached start of anchoring snarl " << front.snarl() << endl;
 #endif
             
             // Say we got to the right place
+            list<Visit> path = trace_path(head);
             toReturn.emplace(bp_length(path), move(path));
             
             // Don't bother looking for extensions, we already got there.
-        } else if (path.front().node_id() == 0 && path.front().backward() &&
-            index.by_id.count(path.front().snarl().end().node_id())) {
+        } else if (front.node_id() == 0 && front.backward() &&
+            index.by_id.count(front.snarl().end().node_id())) {
             // This visit is to a snarl in reverse, which is on the reference
             // path on its right end.
             
 #ifdef debug
-            cerr << "Reached end of anchoring snarl " << path.front().snarl() << endl;
+            cerr << "Reached end of anchoring snarl " << front.snarl() << endl;
 #endif
             
             // Say we got to the right place
+            list<Visit> path = trace_path(head);
             toReturn.emplace(bp_length(path), move(path));
             
             // Don't bother looking for extensions, we already got there.
-        } else if (path.size() <= max_depth) {
+        } else if (depth <= max_depth) {
             // We haven't hit the reference path yet, but we also haven't hit
             // the max depth. Extend with all the possible extensions.
             
             // Look left, possibly entering child snarls
-            vector<Visit> prevVisits = visits_left(path.front(), augmented.graph, child_boundary_index);
+            vector<Visit> prevVisits = visits_left(front, augmented.graph, child_boundary_index);
             
 #ifdef debug
             cerr << "Consider " << prevVisits.size() << " prev visits" << endl;
@@ -1944,7 +2026,7 @@ set<pair<size_t, list<Visit>>> RepresentativeTraversalFinder::bfs_left(Visit vis
                     
                     // Make sure the edge is real, since it can't be a back-to-
                     // back site
-                    Edge* edge = augmented.graph.get_edge(to_right_side(prevVisit), to_left_side(path.front()));
+                    Edge* edge = augmented.graph.get_edge(to_right_side(prevVisit), to_left_side(front));
                     assert(edge != NULL);
                 
                     // Fetch the actual node
@@ -2013,16 +2095,15 @@ set<pair<size_t, list<Visit>>> RepresentativeTraversalFinder::bfs_left(Visit vis
 #endif
             
                 // Make a new path extended left with the node
-                list<Visit> extended(path);
-                extended.push_front(prevVisit);
-                toExtend.emplace_back(move(extended));
+                steps.push_back(SearchStep{prevVisit, head, depth + 1});
+                toExtend.push_back(steps.size() - 1);
                 stillToExtend++;
                 
                 // Remember we found a way to this node, so we don't try and
                 // visit it other ways.
                 alreadyQueued.insert(prevVisit);
             }
-        } else if (path.size() >= max_depth) {
+        } else if (depth >= max_depth) {
 #ifdef debug
             cerr << "Path has reached max depth! Aborting!" << endl;
 #endif
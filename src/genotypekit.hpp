@@ -270,6 +270,10 @@ class CactusUltrabubbleFinder : public SnarlFinder {
     /// Indicates whether bubbles that consist of a single edge should be filtered
     bool filter_trivial_bubbles;
     
+    /// Run Cactus on a single connected component (which must be sorted) and
+    /// append the Snarls it finds to the given vector, parents before children.
+    void find_component_snarls(VG& component, vector<Snarl>& converted_snarls);
+    
 public:
     /**
      * Make a new CactusSiteFinder to find sites in the given graph.
@@ -279,8 +283,9 @@ public:
                             bool filter_trivial_bubbles = false);
     
     /**
-     * Find all the sites in parallel with Cactus, make the site tree, and call
-     * the given function on all the top-level sites.
+     * Find all the sites with Cactus and make the site tree. Each connected
+     * component of the graph gets its own Cactus graph, and the components are
+     * decomposed in parallel.
      */
     virtual SnarlManager find_snarls();
     
@@ -597,8 +597,18 @@ namespace vg {
 
             // Unfold/unroll, find the superbubbles, and translate back.
             graph.sort();
-            sites = use_cactus ? find_sites_with_cactus(graph, ref_path_name)
-            : find_sites_with_supbub(graph);
+            if (!snarls_file_name.empty()) {
+                // We already know the sites
+                ifstream snarls_stream(snarls_file_name);
+                if (!snarls_stream) {
+                    cerr << "error:[vg genotype] could not open snarls file " << snarls_file_name << endl;
+                    exit(1);
+                }
+                sites = load_sites(graph, snarls_stream);
+            } else {
+                sites = use_cactus ? find_sites_with_cactus(graph, ref_path_name)
+                : find_sites_with_supbub(graph);
+            }
 
 
 
@@ -1128,6 +1138,35 @@ namespace vg {
         return to_return;
     }
 
+    vector<Genotyper::Site> Genotyper::load_sites(VG& graph, istream& snarls_stream) {
+
+        vector<Site> to_return;
+
+        SnarlManager snarl_manager(snarls_stream);
+
+        // Walk the snarl tree parents first
+        list<const Snarl*> stack;
+        const vector<const Snarl*>& roots = snarl_manager.top_level_snarls();
+        stack.insert(stack.end(), roots.rbegin(), roots.rend());
+        while (!stack.empty()) {
+            const Snarl* snarl = stack.back();
+            stack.pop_back();
+
+            Site site;
+            site.start = NodeTraversal(graph.get_node(snarl->start().node_id()), snarl->start().backward());
+            site.end = NodeTraversal(graph.get_node(snarl->end().node_id()), snarl->end().backward());
+            for (Node* node : snarl_manager.deep_contents(snarl, graph, true).first) {
+                site.contents.insert(node->id());
+            }
+            to_return.emplace_back(std::move(site));
+
+            const vector<const Snarl*>& children = snarl_manager.children_of(snarl);
+            stack.insert(stack.end(), children.rbegin(), children.rend());
+        }
+
+        return to_return;
+    }
+
     vector<list<NodeTraversal>> Genotyper::get_paths_through_site(VG& graph, const Site& site,
             const map<string, Alignment*>& reads_by_name) {
         // We're going to emit traversals supported by any paths in the graph.
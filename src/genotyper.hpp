@@ -96,6 +96,11 @@ public:
     // affinities for everything?
     bool realign_indels = false;
     
+    // If set, load the augmented graph's snarls from this file (as written by
+    // "vg snarls" on the graph dumped with the augmented file name) instead of
+    // finding sites again. Not used when working on a subset graph.
+    string snarls_file_name;
+    
     // If base qualities aren't available, what is the Phred-scale qualtiy of a
     // piece of sequence being correct?
     int default_sequence_quality = 15;
@@ -193,6 +198,13 @@ public:
      */
     vector<Site> find_sites_with_cactus(VG& graph, const string& ref_path_name = "");
     
+    /**
+     * Make Sites for all the snarls in a serialized snarl tree index for the
+     * graph, instead of finding them again. Sites are produced parents
+     * first, like find_sites_with_cactus().
+     */
+    vector<Site> load_sites(VG& graph, istream& snarls_stream);
+    
     /**
      * Given a path (which may run either direction through a site, or not touch
      * the ends at all), collect a list of NodeTraversals in order for the part
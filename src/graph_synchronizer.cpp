@@ -7,17 +7,87 @@ namespace vg {
 
 using namespace std;
 
+void SharedMutex::lock() {
+    std::unique_lock<std::mutex> lk(state_lock);
+    writers_waiting++;
+    state_changed.wait(lk, [&]{
+        return !writing && readers == 0;
+    });
+    writers_waiting--;
+    writing = true;
+}
+
+void SharedMutex::unlock() {
+    {
+        std::lock_guard<std::mutex> guard(state_lock);
+        writing = false;
+    }
+    state_changed.notify_all();
+}
+
+void SharedMutex::lock_shared() {
+    std::unique_lock<std::mutex> lk(state_lock);
+    state_changed.wait(lk, [&]{
+        return !writing && writers_waiting == 0;
+    });
+    readers++;
+}
+
+void SharedMutex::unlock_shared() {
+    bool last_reader;
+    {
+        std::lock_guard<std::mutex> guard(state_lock);
+        readers--;
+        last_reader = (readers == 0);
+    }
+    if (last_reader) {
+        // Only a writer could be waiting on us
+        state_changed.notify_all();
+    }
+}
+
+SharedLockGuard::SharedLockGuard(SharedMutex& shared_mutex) : shared_mutex(shared_mutex) {
+    shared_mutex.lock_shared();
+}
+
+SharedLockGuard::~SharedLockGuard() {
+    shared_mutex.unlock_shared();
+}
+
 GraphSynchronizer::GraphSynchronizer(VG& graph) : graph(graph) {
     // Nothing to do!
 }
 
 void GraphSynchronizer::with_path_index(const string& path_name, const function<void(const PathIndex&)>& to_run) {
-    // Get a reader lock on the graph
+    {
+        // If the index exists, we only need the index lock to read it, and
+        // we don't have to wait on anyone extracting subgraphs. Other readers
+        // can share it.
+        SharedLockGuard guard(indexes_lock);
+        auto found = indexes.find(path_name);
+        if (found != indexes.end()) {
+            to_run(found->second);
+            return;
+        }
+    }
+    
+    // Otherwise we need the graph to make the index from. Nobody can change
+    // the indexes while we hold the graph lock.
     std::lock_guard<std::mutex> guard(whole_graph_lock);
     to_run(get_path_index(path_name));
 }
 
 const string& GraphSynchronizer::get_path_sequence(const string& path_name) {
+    {
+        // The sequence never changes once the index is made, so if it is
+        // made we can just hand it out.
+        SharedLockGuard guard(indexes_lock);
+        auto found = indexes.find(path_name);
+        if (found != indexes.end()) {
+            return found->second.sequence;
+        }
+    }
+
     // Lock the whole graph
     std::lock_guard<std::mutex> guard(whole_graph_lock);
     
@@ -30,21 +100,30 @@ const string& GraphSynchronizer::get_path_sequence(const string& path_name) {
 // We need a function to grab the index for a path
 PathIndex& GraphSynchronizer::get_path_index(const string& path_name) {
 
-    if (!indexes.count(path_name)) {
-        // Not already made. Generate it.
-        indexes.emplace(piecewise_construct,
+    auto found = indexes.find(path_name);
+    if (found == indexes.end()) {
+        // Not already made. Generate it. Readers only holding the index lock
+        // may be looking at the map, so we need that lock too.
+        std::lock_guard<SharedMutex> guard(indexes_lock);
+        found = indexes.emplace(piecewise_construct,
             forward_as_tuple(path_name), // Make the key
-            forward_as_tuple(graph, path_name, true)); // Make the PathIndex
+            forward_as_tuple(graph, path_name, true)).first; // Make the PathIndex
     }
-    return indexes.at(path_name);
+    return found->second;
 }
 
 void GraphSynchronizer::update_path_indexes(const vector<Translation>& translations) {
+    // Keep out readers that only hold the index lock
+    std::lock_guard<SharedMutex> guard(indexes_lock);
+    
     for (auto& kv : indexes) {
         // We need to touch every index (IN PLACE!)
         
         // Feed each index all the translations, which it will parse into node-
-        // partitioning translations and then apply.
+        // partitioning translations and then apply. Indexes of paths the
+        // translations don't touch are left alone, and the ones they do touch
+        // keep their flat lookup tables, falling back to the map only inside
+        // the divided nodes.
         kv.second.apply_translations(translations);
     }
 }
@@ -336,10 +415,10 @@ vector<Translation> GraphSynchronizer::Lock::apply_edit(const Path& path, set<No
             // For every mapping to a node on that path
             auto node_id = new_path.mapping(i).position().node_id();
             
-            if (!locked_nodes.count(i)) {
+            if (!locked_nodes.count(node_id)) {
                 // If it's not already locked, lock it.
-                locked_nodes.insert(i);
-                synchronizer.locked_nodes.insert(i);
+                locked_nodes.insert(node_id);
+                synchronizer.locked_nodes.insert(node_id);
             }
         }
     }
@@ -17,6 +17,48 @@ namespace vg {
 
 using namespace std;
 
+/**
+ * A mutex that many readers can hold at once, or else one writer, standing in
+ * for C++17's shared_mutex. Writers waiting for the lock go ahead of readers
+ * that arrive after them, so a steady stream of readers can't starve them.
+ * Use std::lock_guard to hold it exclusively and SharedLockGuard to hold it
+ * shared.
+ */
+class SharedMutex {
+public:
+    /// Block until we are the only holder.
+    void lock();
+    /// Release exclusive ownership.
+    void unlock();
+    /// Block until no writer holds or is waiting for the lock, and then hold
+    /// it along with any other readers.
+    void lock_shared();
+    /// Release shared ownership.
+    void unlock_shared();
+    
+private:
+    mutex state_lock;
+    condition_variable state_changed;
+    /// How many readers hold the lock
+    size_t readers = 0;
+    /// How many writers are waiting for it
+    size_t writers_waiting = 0;
+    /// Whether a writer holds it
+    bool writing = false;
+};
+
+/**
+ * Holds shared ownership of a SharedMutex for its lifetime.
+ */
+class SharedLockGuard {
+public:
+    SharedLockGuard(SharedMutex& shared_mutex);
+    ~SharedLockGuard();
+    
+private:
+    SharedMutex& shared_mutex;
+};
+
 /**
  * Let threads get exclusive locks on subgraphs of a vg graph, for reading and
  * editing. Whan a subgraph is locked, a copy is accessible through the lock
@@ -43,9 +85,11 @@ public:
     const string& get_path_sequence(const string& path_name);
     
     /**
-     * We can actually let users run whatever function they want with an
-     * exclusive handle on a PathIndex, with the guarantee that the graph won't
-     * change while they're working.
+     * We can actually let users run whatever function they want with a
+     * read-only handle on a PathIndex, with the guarantee that the index won't
+     * change while they're working. Several threads may be reading the same
+     * index at once. The function must not call back into the
+     * GraphSynchronizer.
      */
     void with_path_index(const string& path_name, const function<void(const PathIndex&)>& to_run);
     
@@ -197,20 +241,28 @@ protected:
     /// they can have all their nodes this time.
     condition_variable wait_for_region;
     
+    /// This protects the PathIndexes. They are only ever modified by someone
+    /// holding both this (exclusively) and whole_graph_lock (which must be
+    /// taken first), so holding either one, even this one shared, is enough to
+    /// read them. That lets threads look things up along paths without waiting
+    /// for other threads to finish extracting subgraphs, or for each other.
+    SharedMutex indexes_lock;
+    
     /// We need indexes of all the paths that someone might want to use as a
     /// basis for locking. This holds a PathIndex for each path we touch by path
     /// name.
     map<string, PathIndex> indexes;
     
     /**
-     * Get the index for the given path name. Lock on the indexes and graph must
-     * be held already.
+     * Get the index for the given path name. Lock on the graph must be held
+     * already. Takes the lock on the indexes if the index has to be made.
      */
     PathIndex& get_path_index(const string& path_name);
     
     /**
      * Update all the path indexes according to the given translations. Lock on
-     * the indexes and graph must be held already.
+     * the graph must be held already. Takes the lock on the indexes. Only
+     * indexes of paths visiting the translated nodes actually change.
      */
     void update_path_indexes(const vector<Translation>& translations);
     
@@ -0,0 +1,140 @@
+#include "kmer_range_table.hpp"
+
+namespace vg {
+
+const string KmerRangeTable::EXTENSION = ".kmers";
+
+// packed values of the bases, and the bases they stand for
+static const string kmer_bases = "ACGT";
+
+static inline int kmer_base_value(char c) {
+    switch (c) {
+    case 'A': return 0;
+    case 'C': return 1;
+    case 'G': return 2;
+    case 'T': return 3;
+    default: return -1;
+    }
+}
+
+KmerRangeTable::KmerRangeTable(const gcsa::GCSA& gcsa, const gcsa::LCPArray& lcp, int k) :
+    k(k), index_size(gcsa.size()) {
+
+    if (k < 1 || k > MAX_K) {
+        throw runtime_error("KmerRangeTable: k-mer size must be between 1 and " + to_string(MAX_K));
+    }
+
+    gcsa::range_type full_range = gcsa::range_type(0, gcsa.size() - 1);
+
+    // Fill in the table for suffixes of increasing length, prepending one
+    // base at a time the same way backward search does. A suffix of length j
+    // packs into j * 2 bits, so prepending base c to suffix s gives c * 4^j + s.
+    ranges.assign(1, full_range);
+    last_lcps.assign(1, 0);
+    max_lcps.assign(1, 0);
+    for (int j = 0; j < k; j++) {
+        size_t suffixes = ranges.size();
+        vector<gcsa::range_type> next_ranges(suffixes * 4);
+        vector<int32_t> next_last_lcps(suffixes * 4, 0);
+        vector<int32_t> next_max_lcps(suffixes * 4, 0);
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (size_t i = 0; i < suffixes * 4; i++) {
+            size_t c = i / suffixes;
+            size_t s = i % suffixes;
+            if (gcsa::Range::empty(ranges[s])) {
+                next_ranges[i] = ranges[s];
+                continue;
+            }
+            next_ranges[i] = gcsa.LF(ranges[s], gcsa.alpha.char2comp[kmer_bases[c]]);
+            if (!gcsa::Range::empty(next_ranges[i])) {
+                next_last_lcps[i] = lcp.parent(next_ranges[i]).lcp();
+                next_max_lcps[i] = max(max_lcps[s], next_last_lcps[i]);
+            }
+        }
+        ranges = std::move(next_ranges);
+        last_lcps = std::move(next_last_lcps);
+        max_lcps = std::move(next_max_lcps);
+    }
+}
+
+void KmerRangeTable::load(istream& in) {
+    string magic(4, ' ');
+    in.read(&magic[0], 4);
+    if (!in || magic != "KRT1") {
+        throw runtime_error("KmerRangeTable: input is not a k-mer range table");
+    }
+    in.read((char*) &k, sizeof(k));
+    in.read((char*) &index_size, sizeof(index_size));
+    if (!in || k < 1 || k > MAX_K) {
+        throw runtime_error("KmerRangeTable: corrupt k-mer range table");
+    }
+    size_t entries = (size_t) 1 << (2 * k);
+    ranges.resize(entries);
+    last_lcps.resize(entries);
+    max_lcps.resize(entries);
+    in.read((char*) ranges.data(), entries * sizeof(gcsa::range_type));
+    in.read((char*) last_lcps.data(), entries * sizeof(int32_t));
+    in.read((char*) max_lcps.data(), entries * sizeof(int32_t));
+    if (!in) {
+        throw runtime_error("KmerRangeTable: truncated k-mer range table");
+    }
+}
+
+void KmerRangeTable::serialize(ostream& out) const {
+    out.write("KRT1", 4);
+    out.write((const char*) &k, sizeof(k));
+    out.write((const char*) &index_size, sizeof(index_size));
+    out.write((const char*) ranges.data(), ranges.size() * sizeof(gcsa::range_type));
+    out.write((const char*) last_lcps.data(), last_lcps.size() * sizeof(int32_t));
+    out.write((const char*) max_lcps.data(), max_lcps.size() * sizeof(int32_t));
+}
+
+int KmerRangeTable::kmer_size(void) const {
+    return k;
+}
+
+bool KmerRangeTable::matches(const gcsa::GCSA& gcsa) const {
+    if (k < 1 || index_size != gcsa.size()) {
+        return false;
+    }
+    
+    // Redo the backward searches for a spread of k-mers and make sure they
+    // land where the table says. Any change to the indexed graph moves some
+    // of the ranges, so with enough samples we will almost surely see it.
+    size_t step = max<size_t>(ranges.size() / MATCH_SAMPLES, 1);
+    for (size_t code = 0; code < ranges.size(); code += step) {
+        gcsa::range_type range = gcsa::range_type(0, gcsa.size() - 1);
+        // The last base is packed least significant, and is searched first
+        for (int j = 0; j < k && !gcsa::Range::empty(range); j++) {
+            range = gcsa.LF(range, gcsa.alpha.char2comp[kmer_bases[(code >> (2 * j)) & 3]]);
+        }
+        if (gcsa::Range::empty(range) != gcsa::Range::empty(ranges[code])) {
+            return false;
+        }
+        if (!gcsa::Range::empty(range) && range != ranges[code]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool KmerRangeTable::find(string::const_iterator end, gcsa::range_type& range,
+                          int& last_lcp, int& max_lcp) const {
+    size_t code = 0;
+    for (auto iter = end - k; iter != end; ++iter) {
+        int value = kmer_base_value(*iter);
+        if (value < 0) {
+            return false;
+        }
+        code = (code << 2) | value;
+    }
+    if (gcsa::Range::empty(ranges[code])) {
+        return false;
+    }
+    range = ranges[code];
+    last_lcp = last_lcps[code];
+    max_lcp = max_lcps[code];
+    return true;
+}
+
+}
@@ -0,0 +1,74 @@
+#ifndef VG_KMER_RANGE_TABLE_H
+#define VG_KMER_RANGE_TABLE_H
+/// \file kmer_range_table.hpp
+/// Defines the KmerRangeTable, which remembers where every short k-mer's
+/// backward search in a GCSA2 index ends up, so MEM finding can skip the
+/// first k LF steps of each search.
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gcsa/gcsa.h"
+#include "gcsa/lcp.h"
+
+namespace vg {
+
+using namespace std;
+
+/**
+ * Table of the GCSA2 ranges of all k-mers over ACGT, along with the LCP
+ * information a backward search picks up on the way to them.
+ */
+class KmerRangeTable {
+public:
+
+    /// Tables are 4^k entries, so don't let them get out of hand
+    static const int MAX_K = 12;
+    /// Tables are saved beside their GCSA2 index with this extension
+    static const string EXTENSION;
+
+    /// Make an empty table, to load into
+    KmerRangeTable(void) = default;
+
+    /// Build the table for all k-mers of the given length by backward search
+    /// in the index, in parallel.
+    KmerRangeTable(const gcsa::GCSA& gcsa, const gcsa::LCPArray& lcp, int k);
+
+    /// Load a table from a stream. Throws runtime_error if it isn't a table.
+    void load(istream& in);
+    /// Save the table to a stream.
+    void serialize(ostream& out) const;
+
+    /// Get the length of the k-mers in the table.
+    int kmer_size(void) const;
+    /// Returns true if the table was built from this index, as far as the
+    /// index size and the backward searches for a sample of the k-mers can
+    /// tell.
+    bool matches(const gcsa::GCSA& gcsa) const;
+
+    /// Look up the k-mer that ends just before end. If it is all ACGT and
+    /// occurs in the index, fill in its range, the LCP of the parent of that
+    /// range, and the largest such parent LCP seen along the way, and return
+    /// true. Otherwise return false.
+    bool find(string::const_iterator end, gcsa::range_type& range,
+              int& last_lcp, int& max_lcp) const;
+
+private:
+
+    /// How many k-mers to search for again when checking an index
+    static const size_t MATCH_SAMPLES = 256;
+
+    int k = 0;
+    /// Size of the index the table was built from
+    size_t index_size = 0;
+    /// Entries are indexed by the k-mer packed 2 bits per base, first base
+    /// most significant
+    vector<gcsa::range_type> ranges;
+    vector<int32_t> last_lcps;
+    vector<int32_t> max_lcps;
+};
+
+}
+
+#endif
@@ -53,7 +53,8 @@ void help_translate(char** argv) {
          << "    -l, --loci FILE       project the input locus descriptions into the from-graph" << endl
          << "    -m, --mapping JSON    print the from-mapping corresponding to the given JSON mapping" << endl
          << "    -P, --position JSON   print the from-position corresponding to the given JSON position" << endl
-         << "    -o, --overlay FILE    overlay this translation on top of the one we are given" << endl;
+         << "    -o, --overlay FILE    overlay this translation on top of the one we are given" << endl
+         << "    -t, --threads N       number of threads to use for paths, alignments and loci [1]" << endl;
 }
 
 int main_translate(int argc, char** argv) {
@@ -69,6 +70,7 @@ int main_translate(int argc, char** argv) {
     string aln_file;
     string loci_file;
     string overlay_file;
+    int threads = 1;
 
     int c;
     optind = 2; // force optind past command positional argument
@@ -82,11 +84,12 @@ int main_translate(int argc, char** argv) {
             {"alns", required_argument, 0, 'a'},
             {"loci", required_argument, 0, 'l'},
             {"overlay", required_argument, 0, 'o'},
+            {"threads", required_argument, 0, 't'},
             {0, 0, 0, 0}
         };
 
         int option_index = 0;
-        c = getopt_long (argc, argv, "hp:m:P:a:o:l:",
+        c = getopt_long (argc, argv, "hp:m:P:a:o:l:t:",
                 long_options, &option_index);
 
         // Detect the end of the options.
@@ -119,6 +122,10 @@ int main_translate(int argc, char** argv) {
             overlay_file = optarg;
             break;
 
+        case 't':
+            threads = atoi(optarg);
+            break;
+
         case 'h':
         case '?':
             help_translate(argv);
@@ -149,33 +156,60 @@ int main_translate(int argc, char** argv) {
         cout << pb2json(translator->translate(mapping)) << endl;
     }
 
+    omp_set_num_threads(threads);
+
+    // each thread translates into its own output buffer, so the translated
+    // messages get reused, and writes are serialized by write_buffered
     if (!path_file.empty()) {
-        vector<Path> buffer;
+        vector<vector<Path>> buffers(get_thread_count());
         function<void(Path&)> lambda = [&](Path& path) {
+            auto& buffer = buffers[omp_get_thread_num()];
             buffer.push_back(translator->translate(path));
             stream::write_buffered(cout, buffer, 100);
         };
         ifstream path_in(path_file);
-        stream::for_each(path_in, lambda);
-        stream::write_buffered(cout, buffer, 0);
+        stream::for_each_parallel(path_in, lambda);
+        for (auto& buffer : buffers) {
+            stream::write_buffered(cout, buffer, 0);
+        }
     } else if (!aln_file.empty()) {
-        vector<Alignment> buffer;
+        vector<vector<Alignment>> buffers(get_thread_count());
+        vector<size_t> used(buffers.size(), 0);
         function<void(Alignment&)> lambda = [&](Alignment& aln) {
-            buffer.push_back(translator->translate(aln));
-            stream::write_buffered(cout, buffer, 100);
+            int tid = omp_get_thread_num();
+            auto& buffer = buffers[tid];
+            // translate into a message left over from the last batch
+            if (used[tid] == buffer.size()) {
+                buffer.emplace_back();
+            }
+            translator->translate(aln, buffer[used[tid]++]);
+            if (used[tid] >= 100) {
+                function<Alignment&(uint64_t)> write_elem = [&buffer](uint64_t i) -> Alignment& {
+                    return buffer[i];
+                };
+#pragma omp critical (stream_out)
+                stream::write(cout, used[tid], write_elem);
+                used[tid] = 0;
+            }
         };
         ifstream aln_in(aln_file);
-        stream::for_each(aln_in, lambda);
-        stream::write_buffered(cout, buffer, 0);
+        stream::for_each_parallel(aln_in, lambda);
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            buffers[i].resize(used[i]);
+            stream::write_buffered(cout, buffers[i], 0);
+        }
     } else if (!loci_file.empty()) {
-        vector<Locus> buffer;
+        vector<vector<Locus>> buffers(get_thread_count());
         function<void(Locus&)> lambda = [&](Locus& locus) {
+            auto& buffer = buffers[omp_get_thread_num()];
             buffer.push_back(translator->translate(locus));
             stream::write_buffered(cout, buffer, 100);
         };
         ifstream loci_in(loci_file);
-        stream::for_each(loci_in, lambda);
-        stream::write_buffered(cout, buffer, 0);
+        stream::for_each_parallel(loci_in, lambda);
+        for (auto& buffer : buffers) {
+            stream::write_buffered(cout, buffer, 0);
+        }
     }
 
     if (!overlay_file.empty()) {
@@ -483,6 +517,10 @@ void help_vectorize(char** argv){
          << "  -p --mem-positions Add the positions to the MEM sketch of a given read based on the GCSA" << endl
          << "  -H --mem-hit-max N Ignore MEMs with this many hits when extracting poisitions" << endl
          << "  -i --identity-hot  Output a score vector based on percent identity and coverage" << endl
+         << "  -s --sparse        Output only the nonzero entries, as index:value pairs after the alignment name" << endl
+         << "  -b --binary        Output only the nonzero entries, as binary records of a uint32 name length," << endl
+         << "                     the name, a uint32 entry count, and uint64 index and double value pairs" << endl
+         << "  -t --threads N     Vectorize in parallel on N threads (sparse and binary output only)" << endl
          << endl;
 }
 
@@ -504,6 +542,8 @@ int main_vectorize(int argc, char** argv){
     bool mem_positions = false;
     bool mem_hit_max = 0;
     int max_mem_length = 0;
+    bool sparse = false;
+    bool binary = false;
 
     if (argc <= 2) {
         help_vectorize(argv);
@@ -530,11 +570,13 @@ int main_vectorize(int argc, char** argv){
             {"identity-hot", no_argument, 0, 'i'},
             {"aln-label", required_argument, 0, 'l'},
             {"reads", required_argument, 0, 'r'},
+            {"sparse", no_argument, 0, 's'},
+            {"binary", no_argument, 0, 'b'},
             {0, 0, 0, 0}
 
         };
         int option_index = 0;
-        c = getopt_long (argc, argv, "AaihwM:fmpx:g:l:H:",
+        c = getopt_long (argc, argv, "AaihwM:fmpx:g:l:H:sbt:",
                 long_options, &option_index);
 
         // Detect the end of the options.
@@ -617,11 +659,25 @@ int main_vectorize(int argc, char** argv){
         case 'M':
             wabbit_mapping_file = optarg;
             break;
+        case 's':
+            sparse = true;
+            break;
+        case 'b':
+            binary = true;
+            break;
+        case 't':
+            omp_set_num_threads(atoi(optarg));
+            break;
         default:
             abort();
         }
     }
 
+    if ((sparse || binary) && mem_sketch) {
+        cerr << "[vg vectorize] error : sparse and binary output are not available for MEM sketches" << endl;
+        return 1;
+    }
+
     xg::XG* xg_index;
     if (!xg_name.empty()) {
         ifstream in(xg_name);
@@ -732,9 +788,47 @@ int main_vectorize(int argc, char** argv){
         }
     };
     
-    get_input_file(optind, argc, argv, [&](istream& in) {
-        stream::for_each(in, lambda);
-    });
+    if (sparse || binary) {
+        // Sparse vectors are only as big as the alignment, so we can make
+        // them in parallel. Each thread collects whole records and writes
+        // them out in batches.
+        vector<string> buffers(get_thread_count());
+        auto flush = [&](string& buffer) {
+#pragma omp critical (cout)
+            cout << buffer;
+            buffer.clear();
+        };
+        function<void(Alignment&)> sparse_lambda = [&](Alignment& a) {
+            auto v = vz.alignment_to_sparse(a, a_hot, use_identity_hot);
+            const string& name = aln_label == "" ? a.name() : aln_label;
+            stringstream record;
+            if (binary) {
+                vz.write_sparse(record, name, v);
+            } else if (output_wabbit) {
+                // the wabbit class map is shared
+#pragma omp critical (wabbit_map)
+                record << vz.wabbitize_sparse(name, v) << endl;
+            } else {
+                record << name << "\t" << vz.format_sparse(v) << endl;
+            }
+            string& buffer = buffers[omp_get_thread_num()];
+            buffer += record.str();
+            if (buffer.size() > 1 << 20) {
+                flush(buffer);
+            }
+        };
+        get_input_file(optind, argc, argv, [&](istream& in) {
+            stream::for_each_parallel(in, sparse_lambda);
+        });
+        for (auto& buffer : buffers) {
+            flush(buffer);
+        }
+        cout.flush();
+    } else {
+        get_input_file(optind, argc, argv, [&](istream& in) {
+            stream::for_each(in, lambda);
+        });
+    }
 
     string mapping_str = vz.output_wabbit_map();
     if (output_wabbit){
@@ -2271,7 +2365,10 @@ void help_sim(char** argv) {
          << "    -v, --frag-std-dev N  use this standard deviation for fragment length estimation" << endl
          << "    -N, --allow-Ns        allow reads to be sampled from the graph with Ns in them" << endl
          << "    -a, --align-out       generate true alignments on stdout rather than reads" << endl
-         << "    -J, --json-out        write alignments in json" << endl;
+         << "    -J, --json-out        write alignments in json" << endl
+         << "    -t, --threads N       sample reads in parallel on N threads. reads are seeded" << endl
+         << "                          individually, so output doesn't depend on N (but differs" << endl
+         << "                          from the output without -t)" << endl;
 }
 
 int main_sim(int argc, char** argv) {
@@ -2293,6 +2390,7 @@ int main_sim(int argc, char** argv) {
     double fragment_std_dev = 0;
     bool reads_may_contain_Ns = false;
     string xg_name;
+    int threads = 0;
 
     int c;
     optind = 2; // force optind past command positional argument
@@ -2312,11 +2410,12 @@ int main_sim(int argc, char** argv) {
             {"indel-error", required_argument, 0, 'i'},
             {"frag-len", required_argument, 0, 'p'},
             {"frag-std-dev", required_argument, 0, 'v'},
+            {"threads", required_argument, 0, 't'},
             {0, 0, 0, 0}
         };
 
         int option_index = 0;
-        c = getopt_long (argc, argv, "hl:n:s:e:i:fax:Jp:v:N",
+        c = getopt_long (argc, argv, "hl:n:s:e:i:fax:Jp:v:Nt:",
                 long_options, &option_index);
 
         // Detect the end of the options.
@@ -2375,6 +2474,10 @@ int main_sim(int argc, char** argv) {
             fragment_std_dev = atof(optarg);
             break;
 
+        case 't':
+            threads = atoi(optarg);
+            break;
+
         case 'h':
         case '?':
             help_sim(argv);
@@ -2404,10 +2507,10 @@ int main_sim(int argc, char** argv) {
         return 1;
     }
 
-    Sampler sampler(xgidx, seed_val, forward_only, reads_may_contain_Ns);
     size_t max_iter = 1000;
-    int nonce = 1;
-    for (int i = 0; i < num_reads; ++i) {
+
+    // sample one read (or pair of reads) with the given sampler
+    auto sample_read = [&](Sampler& sampler) -> vector<Alignment> {
         if (fragment_length) {
             auto alns = sampler.alignment_pair(read_length, fragment_length, fragment_std_dev, base_error, indel_error);
             size_t iter = 0;
@@ -2417,19 +2520,7 @@ int main_sim(int argc, char** argv) {
                     alns = sampler.alignment_pair(read_length, fragment_length, fragment_std_dev, base_error, indel_error);
                 }
             }
-            // write the alignment or its string
-            if (align_out) {
-                // write it out as requested
-                if (json_out) {
-                    cout << pb2json(alns.front()) << endl;
-                    cout << pb2json(alns.back()) << endl;
-                } else {
-                    function<Alignment(uint64_t)> lambda = [&alns](uint64_t n) { return alns[n]; };
-                    stream::write(cout, 2, lambda);
-                }
-            } else {
-                cout << alns.front().sequence() << "\t" << alns.back().sequence() << endl;
-            }
+            return alns;
         } else {
             auto aln = sampler.alignment_with_error(read_length, base_error, indel_error);
             size_t iter = 0;
@@ -2441,18 +2532,74 @@ int main_sim(int argc, char** argv) {
                     }
                 }
             }
+            return vector<Alignment>{aln};
+        }
+    };
+
+    // write out a block of reads, in order
+    auto write_reads = [&](vector<vector<Alignment>>& block) {
+        if (align_out && !json_out) {
+            // write the whole block as one chunk
+            vector<Alignment> buffer;
+            for (auto& alns : block) {
+                for (auto& aln : alns) {
+                    buffer.push_back(aln);
+                }
+            }
+            stream::write_buffered(cout, buffer, 0);
+            return;
+        }
+        stringstream out;
+        for (auto& alns : block) {
             // write the alignment or its string
             if (align_out) {
                 // write it out as requested
-                if (json_out) {
-                    cout << pb2json(aln) << endl;
-                } else {
-                    function<Alignment(uint64_t)> lambda = [&aln](uint64_t n) { return aln; };
-                    stream::write(cout, 1, lambda);
+                for (auto& aln : alns) {
+                    out << pb2json(aln) << "\n";
                 }
+            } else if (alns.size() == 2) {
+                out << alns.front().sequence() << "\t" << alns.back().sequence() << "\n";
             } else {
-                cout << aln.sequence() << endl;
+                out << alns.front().sequence() << "\n";
+            }
+        }
+        cout << out.str();
+    };
+
+    // how many reads to buffer before writing
+    size_t block_size = 1024;
+    vector<vector<Alignment>> block;
+
+    if (threads == 0) {
+        // draw all the reads from one random stream, as we always have
+        Sampler sampler(xgidx, seed_val, forward_only, reads_may_contain_Ns);
+        for (int i = 0; i < num_reads; ++i) {
+            block.push_back(sample_read(sampler));
+            if (block.size() >= block_size) {
+                write_reads(block);
+                block.clear();
+            }
+        }
+        write_reads(block);
+    } else {
+        // seed every read by its number, so it comes out the same on any
+        // thread, and give each thread its own sampler (and node caches)
+        omp_set_num_threads(threads);
+        vector<unique_ptr<Sampler>> samplers;
+        for (int i = 0; i < get_thread_count(); ++i) {
+            samplers.emplace_back(new Sampler(xgidx, seed_val, forward_only, reads_may_contain_Ns));
+        }
+        // give each thread a good-sized piece of each block
+        block_size *= samplers.size();
+        for (size_t block_start = 0; block_start < num_reads; block_start += block_size) {
+            block.resize(min(block_size, num_reads - block_start));
+#pragma omp parallel for schedule(dynamic, 16)
+            for (size_t i = 0; i < block.size(); ++i) {
+                Sampler& sampler = *samplers[omp_get_thread_num()];
+                sampler.set_read_seed(seed_val, block_start + i);
+                block[i] = sample_read(sampler);
             }
+            write_reads(block);
         }
     }
 
@@ -4674,7 +4821,11 @@ void help_map(char** argv) {
          << "    -I, --fragment STR      fragment length distribution specification STR=m:μ:σ:o:d [1e4:0:0:0:1]" << endl
          << "                            max, mean, stdev, orientation (1=same, 0=flip), direction (1=forward, 0=backward)" << endl
          << "    -S, --fragment-x FLOAT  calculate max fragment size as frag_mean+frag_sd*FLOAT [10]" << endl
+         << "    -F, --fragment-model FILE  start from the fragment length distribution saved in FILE, if it" << endl
+         << "                            exists and -I doesn't give one, and save the learned one there when done" << endl
          << "    -O, --mate-rescues INT  attempt up to INT mate rescues per pair [64]" << endl
+         << "    -U, --ungapped-loss INT accept an ungapped extension of a seed without DP if it scores within INT" << endl
+         << "                            of a perfect match [one less than the gap open penalty]" << endl
          << "scoring:" << endl
          << "    -q, --match INT         use this match score [1]" << endl
          << "    -z, --mismatch INT      use this mismatch penalty [4]" << endl
@@ -4700,6 +4851,7 @@ void help_map(char** argv) {
          << "    -K, --keep-secondary    produce alignments for secondary input alignments in addition to primary ones" << endl
          << "    -M, --max-multimaps INT produce up to INT alignments for each read [1]" << endl
          << "    -Q, --mq-max INT        cap the mapping quality at INT [60]" << endl
+         << "    -m, --stats             report how many reads and chains reached each alignment stage to stderr" << endl
          << "    -D, --debug             print debugging information about alignment to stderr" << endl;
 
 }
@@ -4761,6 +4913,7 @@ int main_map(int argc, char** argv) {
     double fragment_sigma = 10;
     bool fragment_orientation = false;
     bool fragment_direction = true;
+    string fragment_model_file;
     bool use_cluster_mq = false;
     float chance_match = 0.05;
     bool use_fast_reseed = true;
@@ -4770,6 +4923,8 @@ int main_map(int argc, char** argv) {
     int kmer_stride = 0;
     int pair_window = 64; // unused
     int mate_rescues = 64;
+    bool report_stats = false;
+    int max_ungapped_loss = -1;
 
     int c;
     optind = 2; // force optind past command positional argument
@@ -4816,6 +4971,7 @@ int main_map(int argc, char** argv) {
                 {"try-up-to", required_argument, 0, 'u'},
                 {"compare", no_argument, 0, 'B'},
                 {"fragment", required_argument, 0, 'I'},
+                {"fragment-model", required_argument, 0, 'F'},
                 {"fragment-x", required_argument, 0, 'S'},
                 {"full-l-bonus", required_argument, 0, 'L'},
                 {"chance-match", required_argument, 0, 'e'},
@@ -4826,11 +4982,13 @@ int main_map(int argc, char** argv) {
                 {"mq-max", required_argument, 0, 'Q'},
                 {"mate-rescues", required_argument, 0, 'O'},
                 {"approx-mq-cap", required_argument, 0, 'E'},
+                {"stats", no_argument, 0, 'm'},
+                {"ungapped-loss", required_argument, 0, 'U'},
                 {0, 0, 0, 0}
             };
 
         int option_index = 0;
-        c = getopt_long (argc, argv, "s:J:Q:d:x:g:T:N:R:c:M:t:G:jb:Kf:iw:P:Dk:Y:r:W:6aH:Z:q:z:o:y:Au:BI:S:l:e:C:v:V:O:L:n:E:",
+        c = getopt_long (argc, argv, "s:J:Q:d:x:g:T:N:R:c:M:t:G:jb:Kf:iw:P:Dk:Y:r:W:6aH:Z:q:z:o:y:Au:BI:F:S:l:e:C:v:V:O:L:n:E:mU:",
                          long_options, &option_index);
 
 
@@ -5029,6 +5187,10 @@ int main_map(int argc, char** argv) {
         }
         break;
 
+        case 'F':
+            fragment_model_file = optarg;
+            break;
+
         case 'S':
             fragment_sigma = atof(optarg);
             break;
@@ -5037,6 +5199,14 @@ int main_map(int argc, char** argv) {
             mate_rescues = atoi(optarg);
             break;
 
+        case 'm':
+            report_stats = true;
+            break;
+
+        case 'U':
+            max_ungapped_loss = atoi(optarg);
+            break;
+
         case 'h':
         case '?':
             /* getopt_long already printed an error message. */
@@ -5113,6 +5283,8 @@ int main_map(int argc, char** argv) {
     xg::XG* xindex = nullptr;
     gcsa::GCSA* gcsa = nullptr;
     gcsa::LCPArray* lcp = nullptr;
+    KmerRangeTable* kmer_ranges = nullptr;
+    DistanceIndex* distance_index = nullptr;
 
     // We try opening the file, and then see if it worked
     ifstream xg_stream(xg_name);
@@ -5145,6 +5317,73 @@ int main_map(int argc, char** argv) {
         lcp->load(lcp_stream);
     }
 
+    // if vg index saved a k-mer range table beside the GCSA2 index, use it
+    string kmer_ranges_name = gcsa_name + KmerRangeTable::EXTENSION;
+    ifstream kmer_ranges_stream(kmer_ranges_name);
+    if (gcsa && kmer_ranges_stream) {
+        if(debug) {
+            cerr << "Loading k-mer range table " << kmer_ranges_name << "..." << endl;
+        }
+        kmer_ranges = new KmerRangeTable();
+        kmer_ranges->load(kmer_ranges_stream);
+        if (!kmer_ranges->matches(*gcsa)) {
+            cerr << "warning:[vg map] ignoring k-mer range table " << kmer_ranges_name
+                 << ", which was not built from " << gcsa_name << endl;
+            delete kmer_ranges;
+            kmer_ranges = nullptr;
+        }
+    }
+
+    // likewise a distance index saved beside the xg index
+    string distance_index_name = xg_name + DistanceIndex::EXTENSION;
+    ifstream distance_index_stream(distance_index_name);
+    if (xindex && distance_index_stream) {
+        if(debug) {
+            cerr << "Loading distance index " << distance_index_name << "..." << endl;
+        }
+        distance_index = new DistanceIndex();
+        try {
+            distance_index->load(distance_index_stream);
+        } catch (const runtime_error& e) {
+            // probably left over from an older vg, with a different format
+            cerr << "warning:[vg map] ignoring distance index " << distance_index_name
+                 << ": " << e.what() << endl;
+            delete distance_index;
+            distance_index = nullptr;
+        }
+        if (distance_index && !distance_index->matches(*xindex)) {
+            cerr << "warning:[vg map] ignoring distance index " << distance_index_name
+                 << ", which was not built from " << xg_name << endl;
+            delete distance_index;
+            distance_index = nullptr;
+        }
+    }
+
+    if (!fragment_model_file.empty() && !fragment_mean) {
+        // pick up the distribution learned by an earlier run, in --fragment format
+        ifstream fragment_model_in(fragment_model_file);
+        string spec;
+        if (fragment_model_in >> spec) {
+            vector<string> parts = split_delims(spec, ":");
+            if (parts.size() != 5) {
+                cerr << "error [vg map] expected five :-delimited numbers in " << fragment_model_file << endl;
+                return 1;
+            }
+            convert(parts[0], fragment_size);
+            convert(parts[1], fragment_mean);
+            convert(parts[2], fragment_stdev);
+            convert(parts[3], fragment_orientation);
+            convert(parts[4], fragment_direction);
+        }
+    }
+
+    // all the threads learn the fragment length distribution together
+    FragmentLengthModel fragment_model;
+    if (fragment_mean) {
+        fragment_model.set_estimate(fragment_size, fragment_mean, fragment_stdev,
+                                    fragment_orientation, fragment_direction);
+    }
+
     thread_count = get_thread_count();
 
     vector<Mapper*> mapper;
@@ -5187,6 +5426,8 @@ int main_map(int argc, char** argv) {
             // Can't continue with null
             throw runtime_error("Need XG, GCSA, and LCP to create a Mapper");
         }
+        m->kmer_ranges = kmer_ranges;
+        m->distance_index = distance_index;
         m->hit_max = hit_max;
         m->max_multimaps = max_multimaps;
         m->min_multimaps = min_multimaps;
@@ -5205,6 +5446,7 @@ int main_map(int argc, char** argv) {
                  << ", min_cluster_length = " << m->min_cluster_length << endl;
         }
         m->fast_reseed = use_fast_reseed;
+        m->max_ungapped_loss = max_ungapped_loss;
         m->mem_chaining = mem_chaining;
         m->max_target_factor = max_target_factor;
         m->set_alignment_scores(match, mismatch, gap_open, gap_extend);
@@ -5221,6 +5463,7 @@ int main_map(int argc, char** argv) {
             m->cached_fragment_orientation = fragment_orientation;
             m->cached_fragment_direction = fragment_direction;
         }
+        m->shared_fragment_model = &fragment_model;
         m->full_length_alignment_bonus = full_length_bonus;
         m->max_mapping_quality = max_mapping_quality;
         m->use_cluster_mq = use_cluster_mq;
@@ -5578,6 +5821,14 @@ int main_map(int argc, char** argv) {
         gam_in.close();
     }
 
+    if (report_stats) {
+        MapperStageStats stage_stats;
+        for (int i = 0; i < thread_count; ++i) {
+            stage_stats += mapper[i]->stage_stats;
+        }
+        stage_stats.print(cerr);
+    }
+
     // clean up
     for (int i = 0; i < thread_count; ++i) {
         delete mapper[i];
@@ -5587,6 +5838,23 @@ int main_map(int argc, char** argv) {
         }
     }
 
+    if (!fragment_model_file.empty() && fragment_model.version()) {
+        // save what we learned for later runs on the same library
+        fragment_model.get_estimate(fragment_size, fragment_mean, fragment_stdev,
+                                    fragment_orientation, fragment_direction);
+        ofstream fragment_model_out(fragment_model_file);
+        fragment_model_out << fragment_size << ":" << fragment_mean << ":" << fragment_stdev << ":"
+                           << fragment_orientation << ":" << fragment_direction << endl;
+    }
+
+    if(kmer_ranges) {
+        delete kmer_ranges;
+        kmer_ranges = nullptr;
+    }
+    if(distance_index) {
+        delete distance_index;
+        distance_index = nullptr;
+    }
     if(gcsa) {
         delete gcsa;
         gcsa = nullptr;
@@ -37,6 +37,7 @@ Mapper::Mapper(Index* idex,
     , min_mem_length(0)
     , mem_chaining(false)
     , fast_reseed(true)
+    , max_ungapped_loss(-1)
     , max_target_factor(128)
     , max_query_graph_ratio(128)
     , extra_multimaps(512)
@@ -697,6 +698,9 @@ pair<vector<Alignment>, vector<Alignment>> Mapper::align_paired_multi(
     bool only_top_scoring_pair,
     bool retrying) {
 
+    // another thread may have learned more about the fragment distribution
+    update_fragment_estimate();
+
     double avg_node_len = average_node_length();
     int8_t match;
     int8_t gap_extension;
@@ -749,6 +753,13 @@ pair<vector<Alignment>, vector<Alignment>> Mapper::align_paired_multi(
                                                      min_mem_length,
                                                      mem_reseed_length);
 
+    // pairs we retry were already counted the first time through
+    if (!retrying) {
+        stage_stats.reads += 2;
+        if (!mems1.empty()) ++stage_stats.seeded;
+        if (!mems2.empty()) ++stage_stats.seeded;
+    }
+
     double mq_cap1, mq_cap2;
     mq_cap1 = mq_cap2 = max_mapping_quality;
 
@@ -897,6 +908,9 @@ pair<vector<Alignment>, vector<Alignment>> Mapper::align_paired_multi(
                                   (int)(fragment_size ? fragment_size : fragment_max)));
         clusters = chainer.traceback(total_multimaps, true, debug);
     }
+    if (!retrying) {
+        stage_stats.chained += clusters.size();
+    }
 
     // don't attempt to align if we reach the maximum number of multimaps
     //if (clusters.size() == total_multimaps) clusters.clear();
@@ -1358,6 +1372,9 @@ Mapper::align_mem_multi(const Alignment& aln, vector<MaximalExactMatch>& mems, d
     int total_multimaps = max_multimaps + additional_multimaps;
     double mq_cap = max_mapping_quality;
 
+    ++stage_stats.reads;
+    if (!mems.empty()) ++stage_stats.seeded;
+
     {
         int mem_max_length = 0;
         for (auto& mem : mems) if (mem.primary && mem.match_count) mem_max_length = max(mem_max_length, (int)mem.length());
@@ -1417,6 +1434,7 @@ Mapper::align_mem_multi(const Alignment& aln, vector<MaximalExactMatch>& mems, d
         MEMChainModel chainer({ aln.sequence().size() }, { mems }, this, transition_weight, aln.sequence().size());
         clusters = chainer.traceback(total_multimaps, false, debug);
     }
+    stage_stats.chained += clusters.size();
 
     // don't attempt to align if we reach the maximum number of multimaps
     //if (clusters.size() == total_multimaps) clusters.clear();
@@ -1476,6 +1494,8 @@ Mapper::align_mem_multi(const Alignment& aln, vector<MaximalExactMatch>& mems, d
     // then fix it up with DP on the little bits between the alignments
     vector<Alignment> alns;
     int multimaps = 0;
+    int32_t best_score = 0;
+    bool accepted_early = false;
     for (auto& cluster : clusters) {
         // filtered out due to overlap with longer chain
         if (to_drop.count(&cluster) && multimaps >= min_multimaps) continue;
@@ -1483,13 +1503,23 @@ Mapper::align_mem_multi(const Alignment& aln, vector<MaximalExactMatch>& mems, d
         // skip this if we don't have sufficient cluster coverage and we have at least two alignments
         // which we can use to estimate mapping quality
         if (min_cluster_length && cluster_coverage(cluster) < min_cluster_length && alns.size() > 1) continue;
+        // accept the read early if we have enough alignments to estimate mapping quality
+        // and this cluster can't give one that beats or ties the best we have
+        if (alns.size() >= max(2, max(min_multimaps, max_multimaps))
+            && cluster_score_bound(aln, cluster, mems, max_mem_length) < best_score) {
+            ++stage_stats.skipped;
+            accepted_early = true;
+            continue;
+        }
         // get the candidate graph
         // align to it
         Alignment candidate = align_cluster(aln, cluster);
         if (candidate.identity() > min_identity) {
+            best_score = max(best_score, candidate.score());
             alns.emplace_back(candidate);
         }
     }
+    if (accepted_early) ++stage_stats.accepted_early;
 
 #pragma omp critical
     if (debug) {
@@ -1602,7 +1632,231 @@ double Mapper::compute_uniqueness(const Alignment& aln, const vector<MaximalExac
     return repeated / aln.sequence().length();
 }
 
+int32_t Mapper::perfect_score(const Alignment& aln) {
+    if (aln.quality().empty() || !adjust_alignments_for_base_quality) {
+        return get_regular_aligner()->score_exact_match(aln.sequence());
+    } else {
+        return get_qual_adj_aligner()->score_exact_match(aln.sequence(), aln.quality());
+    }
+}
+
+int32_t Mapper::cluster_score_bound(const Alignment& aln, const vector<MaximalExactMatch>& cluster,
+                                    const vector<MaximalExactMatch>& mems, int max_mem_length) {
+    int32_t perfect = perfect_score(aln);
+    int read_length = aln.sequence().size();
+    // MEMs are cut at the GCSA order and at max_mem_length, so unless both reach the read length a
+    // perfect match may not have shown up as one, and with base quality adjustment a mismatch can cost nothing
+    int longest_mem = max_mem_length ? min(max_mem_length, (int)gcsa->order()) : (int)gcsa->order();
+    if (longest_mem < read_length
+        || !aln.quality().empty() && adjust_alignments_for_base_quality) {
+        return perfect;
+    }
+    for (auto& mem : mems) {
+        // a perfect match with too many hits to locate could be anywhere, including here
+        if (mem.length() == read_length && mem.nodes.empty()) {
+            return perfect;
+        }
+    }
+    for (auto& mem : cluster) {
+        if (mem.length() == read_length) {
+            return perfect;
+        }
+    }
+    // a perfect match here would have been found as a MEM covering the whole read,
+    // so any alignment here must lose at least a point to a mismatch, gap, or softclip
+    return perfect - 1;
+}
+
+Alignment Mapper::align_cluster_exactly(const Alignment& aln, const vector<MaximalExactMatch>& mems) {
+    Alignment result = aln;
+    result.clear_path();
+    result.clear_score();
+    result.clear_identity();
+    for (auto& mem : mems) {
+        if (mem.length() != aln.sequence().size()) continue;
+        // the MEM hit is a perfect alignment of the read, if we can walk it in the graph
+        Alignment walked = walk_match(aln.sequence(), make_pos_t(mem.nodes.front()));
+        if (walked.path().mapping_size()) {
+            *result.mutable_path() = walked.path();
+            result.set_score(perfect_score(aln));
+            result.set_identity(1.0);
+            break;
+        }
+    }
+    return result;
+}
+
+void Mapper::extend_ungapped(const string& seq, size_t i, pos_t pos, int mismatches, vector<pos_t>& walk,
+                             vector<pos_t>& best_walk, int& best_mismatches, size_t& budget) {
+    if (budget == 0) return;
+    --budget;
+    if (pos_char(pos) != seq[i]) ++mismatches;
+    // give up on walks that can't do better than the best we have
+    if (mismatches >= best_mismatches) return;
+    walk.push_back(pos);
+    if (i + 1 == seq.size()) {
+        best_walk = walk;
+        best_mismatches = mismatches;
+    } else {
+        auto nexts = next_pos_chars(pos);
+        // follow the matching branches first, so that good walks turn up early and prune the rest
+        for (auto& next : nexts) {
+            if (next.second == seq[i+1]) {
+                extend_ungapped(seq, i+1, next.first, mismatches, walk, best_walk, best_mismatches, budget);
+            }
+        }
+        for (auto& next : nexts) {
+            if (next.second != seq[i+1]) {
+                extend_ungapped(seq, i+1, next.first, mismatches, walk, best_walk, best_mismatches, budget);
+            }
+        }
+    }
+    walk.pop_back();
+}
+
+Alignment Mapper::align_cluster_ungapped(const Alignment& aln, const vector<MaximalExactMatch>& mems) {
+    Alignment result = aln;
+    result.clear_path();
+    result.clear_score();
+    result.clear_identity();
+    // with base quality adjustment we can't say what a mismatch costs up front
+    if (mems.empty() || !aln.quality().empty() && adjust_alignments_for_base_quality) {
+        return result;
+    }
+    auto aligner = get_regular_aligner();
+    int max_loss = max_ungapped_loss < 0 ? aligner->gap_open - 1 : max_ungapped_loss;
+    int max_mismatches = max_loss / (aligner->match + aligner->mismatch);
+    const string& seq = aln.sequence();
+    // don't let a tangle of matching branches run away with us
+    size_t budget = 8 * seq.size();
+
+    // walk from the start of the longest MEM to the end of the read
+    auto longest = std::max_element(mems.begin(), mems.end(),
+                                    [](const MaximalExactMatch& m1, const MaximalExactMatch& m2) {
+                                        return m1.length() < m2.length();
+                                    });
+    size_t mem_start = longest->begin - seq.begin();
+    pos_t mem_pos = make_pos_t(longest->nodes.front());
+    vector<pos_t> walk;
+    vector<pos_t> right_walk;
+    int right_mismatches = max_mismatches + 1;
+    extend_ungapped(seq.substr(mem_start), 0, mem_pos, 0, walk, right_walk, right_mismatches, budget);
+    if (right_walk.empty()) {
+        return result;
+    }
+
+    // and walk the reverse complement of the rest back to the start of the read on the other strand
+    auto flip = [&](const pos_t& pos) {
+        return make_pos_t(id(pos), !is_rev(pos), get_node_length(id(pos)) - 1 - offset(pos));
+    };
+    vector<pos_t> left_walk;
+    if (mem_start) {
+        string left_seq = reverse_complement(seq.substr(0, mem_start));
+        int left_mismatches = max_mismatches - right_mismatches + 1;
+        for (auto& next : next_pos_chars(flip(mem_pos))) {
+            extend_ungapped(left_seq, 0, next.first, 0, walk, left_walk, left_mismatches, budget);
+        }
+        if (left_walk.empty()) {
+            return result;
+        }
+    }
+    vector<pos_t> positions;
+    positions.reserve(seq.size());
+    for (auto p = left_walk.rbegin(); p != left_walk.rend(); ++p) {
+        positions.push_back(flip(*p));
+    }
+    positions.insert(positions.end(), right_walk.begin(), right_walk.end());
+
+    // softclip the ends where that scores better, counting the full length bonus as the aligner does
+    vector<int> base_scores(seq.size());
+    int score = 0;
+    for (size_t i = 0; i < seq.size(); ++i) {
+        base_scores[i] = pos_char(positions[i]) == seq[i] ? aligner->match : -aligner->mismatch;
+        score += base_scores[i];
+    }
+    size_t clip_start = 0, clip_end = 0;
+    int clipped = 0, best_gain = 0;
+    for (size_t i = 0; i < seq.size(); ++i) {
+        clipped += base_scores[i];
+        if (-clipped - full_length_alignment_bonus > best_gain) {
+            best_gain = -clipped - full_length_alignment_bonus;
+            clip_start = i + 1;
+        }
+    }
+    clipped = 0;
+    best_gain = 0;
+    for (size_t i = seq.size(); i > clip_start; --i) {
+        clipped += base_scores[i-1];
+        if (-clipped - full_length_alignment_bonus > best_gain) {
+            best_gain = -clipped - full_length_alignment_bonus;
+            clip_end = seq.size() - i + 1;
+        }
+    }
+    if (clip_start + clip_end >= seq.size()) {
+        return result;
+    }
+    score -= std::accumulate(base_scores.begin(), base_scores.begin() + clip_start, 0);
+    score -= std::accumulate(base_scores.end() - clip_end, base_scores.end(), 0);
+    int loss = aligner->score_exact_match(seq) - score
+        + (clip_start ? full_length_alignment_bonus : 0)
+        + (clip_end ? full_length_alignment_bonus : 0);
+    if (loss > max_loss) {
+        return result;
+    }
+
+    // lay the read out along the walk
+    Path& path = *result.mutable_path();
+    Mapping* mapping = nullptr;
+    Edit* edit = nullptr;
+    bool edit_matches = false;
+    for (size_t i = clip_start; i < seq.size() - clip_end; ++i) {
+        auto& pos = positions[i];
+        if (mapping == nullptr || id(pos) != id(positions[i-1]) || is_rev(pos) != is_rev(positions[i-1])
+            || offset(pos) != offset(positions[i-1]) + 1) {
+            mapping = path.add_mapping();
+            *mapping->mutable_position() = make_position(pos);
+            edit = nullptr;
+            if (i == clip_start && clip_start) {
+                Edit* softclip = mapping->add_edit();
+                softclip->set_to_length(clip_start);
+                softclip->set_sequence(seq.substr(0, clip_start));
+            }
+        }
+        bool matches = base_scores[i] > 0;
+        if (edit == nullptr || edit_matches != matches) {
+            edit = mapping->add_edit();
+            edit_matches = matches;
+        }
+        edit->set_from_length(edit->from_length() + 1);
+        edit->set_to_length(edit->to_length() + 1);
+        if (!matches) {
+            edit->mutable_sequence()->push_back(seq[i]);
+        }
+    }
+    if (clip_end) {
+        Edit* softclip = mapping->add_edit();
+        softclip->set_to_length(clip_end);
+        softclip->set_sequence(seq.substr(seq.size() - clip_end));
+    }
+    result.set_score(score);
+    result.set_identity(identity(path));
+    return result;
+}
+
 Alignment Mapper::align_cluster(const Alignment& aln, const vector<MaximalExactMatch>& mems) {
+    // nothing can beat a perfect match, so there's no need for dynamic programming if we have one
+    Alignment exact = align_cluster_exactly(aln, mems);
+    if (exact.score()) {
+        ++stage_stats.exact;
+        return exact;
+    }
+    // nor if the read extends without gaps to an alignment close enough to a perfect match
+    Alignment ungapped = align_cluster_ungapped(aln, mems);
+    if (ungapped.path().mapping_size()) {
+        ++stage_stats.ungapped;
+        return ungapped;
+    }
+    ++stage_stats.aligned;
     // poll the mems to see if we should flip
     int count_fwd = 0, count_rev = 0;
     for (auto& mem : mems) {
@@ -1736,10 +1990,6 @@ void Mapper::record_fragment_configuration(int length, const Alignment& aln1, co
     bool aln1_is_rev = aln1.path().mapping(0).position().is_reverse();
     bool aln2_is_rev = aln2.path().mapping(0).position().is_reverse();
     bool same_orientation = aln1_is_rev == aln2_is_rev;
-    fragment_orientations.push_front(same_orientation);
-    if (fragment_orientations.size() > fragment_length_cache_size) {
-        fragment_orientations.pop_back();
-    }
     // assuming a dag-like graph
     // which direction do we go relative to the orientation of our first mate to find the second?
     bool same_direction = true;
@@ -1754,6 +2004,17 @@ void Mapper::record_fragment_configuration(int length, const Alignment& aln1, co
     } else {
         assert(false);
     }
+    if (shared_fragment_model) {
+        shared_fragment_model->record(abs(length), same_orientation, same_direction,
+                                      fragment_length_cache_size, fragment_length_estimate_interval,
+                                      fragment_sigma);
+        update_fragment_estimate();
+        return;
+    }
+    fragment_orientations.push_front(same_orientation);
+    if (fragment_orientations.size() > fragment_length_cache_size) {
+        fragment_orientations.pop_back();
+    }
     fragment_directions.push_front(same_direction);
     if (fragment_directions.size() > fragment_length_cache_size) {
         fragment_directions.pop_back();
@@ -1775,6 +2036,91 @@ void Mapper::record_fragment_configuration(int length, const Alignment& aln1, co
     }
 }
 
+void Mapper::update_fragment_estimate(void) {
+    if (shared_fragment_model && shared_fragment_model->version() != shared_fragment_version) {
+        shared_fragment_version = shared_fragment_model->get_estimate(fragment_size,
+                                                                      cached_fragment_length_mean,
+                                                                      cached_fragment_length_stdev,
+                                                                      cached_fragment_orientation,
+                                                                      cached_fragment_direction);
+    }
+}
+
+void FragmentLengthModel::record(double length, bool same_orientation, bool same_direction,
+                                 int cache_size, int estimate_interval, double sigma) {
+    std::lock_guard<mutex> guard(model_mutex);
+    orientations.push_front(same_orientation);
+    if (orientations.size() > cache_size) {
+        orientations.pop_back();
+    }
+    directions.push_front(same_direction);
+    if (directions.size() > cache_size) {
+        directions.pop_back();
+    }
+    lengths.push_front(length);
+    if (lengths.size() > cache_size) {
+        lengths.pop_back();
+    }
+    if (++since_last_estimate > estimate_interval) {
+        // same estimates as an unshared Mapper makes
+        mean = std::accumulate(lengths.begin(), lengths.end(), 0.0) / lengths.size();
+        stdev = vg::stdev(lengths);
+        orientation = (size_t) std::count(orientations.begin(), orientations.end(), true) * 2 > orientations.size();
+        direction = (size_t) std::count(directions.begin(), directions.end(), true) * 2 > directions.size();
+        fragment_size = mean + sigma * stdev;
+        since_last_estimate = 1;
+        ++estimate_version;
+    }
+}
+
+void FragmentLengthModel::set_estimate(int fragment_size, double mean, double stdev, bool orientation, bool direction) {
+    std::lock_guard<mutex> guard(model_mutex);
+    this->fragment_size = fragment_size;
+    this->mean = mean;
+    this->stdev = stdev;
+    this->orientation = orientation;
+    this->direction = direction;
+    ++estimate_version;
+}
+
+uint64_t FragmentLengthModel::get_estimate(int& fragment_size, double& mean, double& stdev,
+                                           bool& orientation, bool& direction) {
+    std::lock_guard<mutex> guard(model_mutex);
+    fragment_size = this->fragment_size;
+    mean = this->mean;
+    stdev = this->stdev;
+    orientation = this->orientation;
+    direction = this->direction;
+    return estimate_version;
+}
+
+uint64_t FragmentLengthModel::version(void) const {
+    return estimate_version.load();
+}
+
+MapperStageStats& MapperStageStats::operator+=(const MapperStageStats& other) {
+    reads += other.reads;
+    seeded += other.seeded;
+    chained += other.chained;
+    exact += other.exact;
+    ungapped += other.ungapped;
+    aligned += other.aligned;
+    skipped += other.skipped;
+    accepted_early += other.accepted_early;
+    return *this;
+}
+
+void MapperStageStats::print(ostream& out) const {
+    out << "reads\t" << reads << endl
+        << "seeded\t" << seeded << endl
+        << "chained\t" << chained << endl
+        << "exact\t" << exact << endl
+        << "ungapped\t" << ungapped << endl
+        << "aligned\t" << aligned << endl
+        << "skipped\t" << skipped << endl
+        << "accepted_early\t" << accepted_early << endl;
+}
+
 double Mapper::fragment_length_stdev(void) {
     return stdev(fragment_lengths);
 }
@@ -2709,14 +3055,16 @@ Mapper::find_mems_simple(string::const_iterator seq_begin,
     std::reverse(mems.begin(), mems.end());
 
     // fill the counts before deciding what to do
+    vector<MaximalExactMatch*> to_locate;
     for (auto& mem : mems) {
         if (mem.length() >= min_mem_length) {
             mem.match_count = gcsa->count(mem.range);
             if (mem.match_count > 0 && (!hit_max || mem.match_count <= hit_max)) {
-                gcsa->locate(mem.range, mem.nodes);
+                to_locate.push_back(&mem);
             }
         }
     }
+    locate_mems(to_locate);
     
     // reseed the long smems with shorter mems
     if (reseed_length) {
@@ -2905,6 +3253,22 @@ vector<MaximalExactMatch> Mapper::find_mems_deep(string::const_iterator seq_begi
             continue;
         }
         
+        // when starting a fresh match, jump straight to the range of the
+        // k-mer ending at the cursor if it's in the table
+        if (kmer_ranges && match.range == full_range && match.end == cursor + 1
+            && cursor - seq_begin + 1 >= kmer_ranges->kmer_size()
+            && (!max_mem_length || kmer_ranges->kmer_size() <= max_mem_length)
+            && kmer_ranges->kmer_size() <= gcsa->order()) {
+            int kmer_max_lcp;
+            if (kmer_ranges->find(cursor + 1, match.range, max_lcp, kmer_max_lcp)) {
+                prev_iter_jumped_lcp = false;
+                // stands in for the LCPs of all the steps we skipped
+                lcp_maxima.push_back(kmer_max_lcp);
+                cursor -= kmer_ranges->kmer_size();
+                continue;
+            }
+        }
+        
         // hold onto our previous range
         last_range = match.range;
         
@@ -3053,14 +3417,15 @@ vector<MaximalExactMatch> Mapper::find_mems_deep(string::const_iterator seq_begi
     lcp_maxima.push_back(max_lcp);
     longest_lcp = *max_element(lcp_maxima.begin(), lcp_maxima.end());
 
-    // fill the MEMs' node lists and indicate they are primary MEMs
+    // count the MEMs' hits and indicate they are primary MEMs
+    vector<MaximalExactMatch*> to_locate;
     for (MaximalExactMatch& mem : mems) {
         mem.match_count = gcsa->count(mem.range);
         mem.primary = true;
         // if we aren't filtering on hit count, or if we have up to the max allowed hits
         if (mem.match_count > 0 && (!hit_max || mem.match_count <= hit_max)) {
-            // extract the graph positions matching the range
-            gcsa->locate(mem.range, mem.nodes);
+            // we'll extract the graph positions matching the range
+            to_locate.push_back(&mem);
         }
     }
     
@@ -3075,15 +3440,20 @@ vector<MaximalExactMatch> Mapper::find_mems_deep(string::const_iterator seq_begi
             }
         }
 
-        // fill MEMs with positions and set flag indicating they are submems
+        // set flag indicating they are submems, and locate them along with the MEMs
         for (auto& m : sub_mems) {
             auto& mem = m.first;
             mem.primary = false;
             if (mem.match_count > 0 && (!hit_max || mem.match_count <= hit_max)) {
-                gcsa->locate(mem.range, mem.nodes);
+                to_locate.push_back(&mem);
             }
         }
-
+    }
+    
+    // fill the MEMs with positions
+    locate_mems(to_locate);
+    
+    if (reseed_length) {
         // combine the MEM and sub-MEM lists
         for (auto iter = sub_mems.begin(); iter != sub_mems.end(); iter++) {
             mems.push_back(std::move((*iter).first));
@@ -3426,6 +3796,41 @@ void Mapper::find_sub_mems_fast(vector<MaximalExactMatch>& mems,
     }
 }
     
+void Mapper::locate_mems(const vector<MaximalExactMatch*>& mems) {
+    
+    // visit the ranges in suffix array order, so the sampled positions they
+    // walk to are looked up in roughly increasing order
+    vector<size_t> order(mems.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return mems[a]->range.first < mems[b]->range.first;
+    });
+    
+    // collect all the hits in one buffer, remembering which belong to which MEM
+    size_t total_hits = 0;
+    for (auto mem : mems) {
+        if (!gcsa::Range::empty(mem->range)) {
+            total_hits += mem->range.second + 1 - mem->range.first;
+        }
+    }
+    vector<gcsa::node_type> hits;
+    hits.reserve(total_hits);
+    vector<pair<size_t, size_t>> mem_hits(mems.size());
+    for (size_t i : order) {
+        mem_hits[i].first = hits.size();
+        gcsa->locate(mems[i]->range, hits, true, false);
+        mem_hits[i].second = hits.size();
+    }
+    
+    // hand each MEM its hits, deduplicated the same way locate would
+    for (size_t i = 0; i < mems.size(); i++) {
+        mems[i]->nodes.assign(hits.begin() + mem_hits[i].first, hits.begin() + mem_hits[i].second);
+        gcsa::removeDuplicates(mems[i]->nodes, false);
+    }
+}
+
 void Mapper::first_hit_positions_by_index(MaximalExactMatch& mem,
                                           vector<set<pos_t>>& positions_by_index_out) {
     // find the hit to the first index in the parent MEM's range
@@ -3486,11 +3891,11 @@ void Mapper::fill_nonredundant_sub_mem_nodes(vector<MaximalExactMatch>& parent_m
             first_parent_mem_hit_positions.push_back(&(positions_by_index[parent_idx][offset]));
         }
         
+        vector<gcsa::node_type> hits;
         for (gcsa::size_type i = sub_mem.range.first; i <= sub_mem.range.second; i++) {
             
             // add the locations of the hits, but do not remove duplicates yet
-            vector<gcsa::node_type> hits;
-            gcsa->locate(i, hits, true, false);
+            gcsa->locate(i, hits, false, false);
             
             // the number of subsequent hits (including these) that are inside a parent MEM
             size_t parent_hit_jump = 0;
@@ -3680,6 +4085,10 @@ map<pos_t, char> Mapper::next_pos_chars(pos_t pos) {
 }
 
 int Mapper::graph_distance(pos_t pos1, pos_t pos2, int maximum) {
+    int64_t distance;
+    if (distance_index && distance_index->min_distance(pos1, pos2, distance)) {
+        return distance < 0 || distance > maximum ? maximum : distance;
+    }
     return xg_cached_distance(pos1, pos2, maximum, xindex, get_node_cache(), get_edge_cache());
 }
 
@@ -3692,6 +4101,22 @@ int Mapper::approx_position(pos_t pos) {
 }
 
 int Mapper::approx_distance(pos_t pos1, pos_t pos2) {
+    if (distance_index) {
+        // measure along the forward strand, in whichever direction gets there
+        if (is_rev(pos1)) {
+            pos1 = reverse(pos1, xg_cached_node_length(id(pos1), xindex, get_node_cache()));
+        }
+        if (is_rev(pos2)) {
+            pos2 = reverse(pos2, xg_cached_node_length(id(pos2), xindex, get_node_cache()));
+        }
+        int64_t distance;
+        if (distance_index->min_distance(pos1, pos2, distance) && distance >= 0) {
+            return -distance;
+        }
+        if (distance_index->min_distance(pos2, pos1, distance) && distance >= 0) {
+            return distance;
+        }
+    }
     return approx_position(pos1) - approx_position(pos2);
 }
 
@@ -3713,6 +4138,11 @@ int Mapper::approx_alignment_position(const Alignment& aln) {
 /// returns approximate distance between alignment starts
 /// or -1.0 if not possible to determine
 int Mapper::approx_fragment_length(const Alignment& aln1, const Alignment& aln2) {
+    if (distance_index && aln1.path().mapping_size() && aln1.path().mapping(0).has_position()
+        && aln2.path().mapping_size() && aln2.path().mapping(0).has_position()) {
+        return abs(approx_distance(make_pos_t(aln1.path().mapping(0).position()),
+                                   make_pos_t(aln2.path().mapping(0).position())));
+    }
     int pos1 = approx_alignment_position(aln1);
     int pos2 = approx_alignment_position(aln2);
     if (pos1 != -1 && pos2 != -1) {
@@ -4080,6 +4510,15 @@ Alignment Mapper::surject_alignment(const Alignment& source,
         return surjection;
     }
 
+    // Most alignments already follow one of the paths, and we can project
+    // them straight onto it instead of realigning against it
+    if (surject_by_projection(source, path_names, path_name, path_pos, path_reverse)) {
+        *surjection.mutable_path() = source.path();
+        surjection.set_score(source.score());
+        surjection.set_identity(source.identity());
+        return surjection;
+    }
+
     set<id_t> nodes;
     for (int i = 0; i < source.path().mapping_size(); ++ i) {
         nodes.insert(source.path().mapping(i).position().node_id());
@@ -4195,6 +4634,82 @@ Alignment Mapper::surject_alignment(const Alignment& source,
     return surjection;
 }
 
+bool Mapper::surject_by_projection(const Alignment& source,
+                                   const set<string>& path_names,
+                                   string& path_name,
+                                   int64_t& path_pos,
+                                   bool& path_reverse) {
+
+    const Path& path = source.path();
+    if (path.mapping_size() == 0) {
+        return false;
+    }
+
+    // find the one path we could be on
+    string candidate;
+    id_t first_node = path.mapping(0).position().node_id();
+    for (auto& name : path_names) {
+        if (!xindex->position_in_path(first_node, name).empty()) {
+            if (!candidate.empty()) {
+                // more than one path to choose from
+                return false;
+            }
+            candidate = name;
+        }
+    }
+    if (candidate.empty()) {
+        return false;
+    }
+
+    // Walk the mappings, making sure each new node is visited once by the
+    // path, in the same relative orientation as the ones before, and abuts the
+    // previous node along the path.
+    bool reverse = false;
+    int64_t first_node_pos = 0;
+    int64_t node_pos = 0;
+    int64_t node_length = 0;
+    for (int i = 0; i < path.mapping_size(); ++i) {
+        const Position& position = path.mapping(i).position();
+        if (i > 0 && position.node_id() == path.mapping(i - 1).position().node_id()) {
+            // more of the node we just checked
+            if (position.is_reverse() != path.mapping(i - 1).position().is_reverse()) {
+                return false;
+            }
+            continue;
+        }
+        auto posns = xindex->position_in_path(position.node_id(), candidate);
+        if (posns.size() != 1) {
+            return false;
+        }
+        int64_t prev_node_pos = node_pos;
+        int64_t prev_node_length = node_length;
+        node_pos = posns.front();
+        node_length = get_node_length(position.node_id());
+        bool node_reverse = position.is_reverse()
+            != xindex->mapping_at_path_position(candidate, node_pos).position().is_reverse();
+        if (i == 0) {
+            reverse = node_reverse;
+            first_node_pos = node_pos;
+        } else if (node_reverse != reverse
+                   || (!reverse && node_pos != prev_node_pos + prev_node_length)
+                   || (reverse && node_pos + node_length != prev_node_pos)) {
+            return false;
+        }
+    }
+
+    path_name = candidate;
+    path_reverse = reverse;
+    if (!reverse) {
+        // the first mapping is leftmost on the path
+        path_pos = first_node_pos + path.mapping(0).position().offset();
+    } else {
+        // the last mapping is leftmost on the path, but runs against it
+        const Mapping& last = path.mapping(path.mapping_size() - 1);
+        path_pos = node_pos + node_length - last.position().offset() - mapping_from_length(last);
+    }
+    return true;
+}
+
 const int balanced_stride(int read_length, int kmer_size, int stride) {
     double r = read_length;
     double k = kmer_size;
@@ -4255,79 +4770,87 @@ MEMChainModel::MEMChainModel(
             }
         }
     }
-    // index the model with the positions
-    for (vector<MEMChainModelVertex>::iterator v = model.begin(); v != model.end(); ++v) {
-        approx_positions[v->approx_position].push_back(v);
-    }
-    // sort the vertexes at each approx position by their matches and trim
-    for (auto& pos : approx_positions) {
-        std::sort(pos.second.begin(), pos.second.end(), [](const vector<MEMChainModelVertex>::iterator& v1,
-                                                           const vector<MEMChainModelVertex>::iterator& v2) {
-                      return v1->mem.length() > v2->mem.length();
-                  });
-        if (pos.second.size() > position_depth) {
-            for (int i = position_depth; i < pos.second.size(); ++i) {
-                redundant_vertexes.insert(pos.second[i]);
+    // index the model with the positions, sorting the vertexes at each approx
+    // position by their matches and trimming them
+    vector<MEMChainModelVertex*> sorted_vertexes;
+    sorted_vertexes.reserve(model.size());
+    for (auto& v : model) {
+        sorted_vertexes.push_back(&v);
+    }
+    std::stable_sort(sorted_vertexes.begin(), sorted_vertexes.end(), [](const MEMChainModelVertex* v1,
+                                                                        const MEMChainModelVertex* v2) {
+            return v1->approx_position < v2->approx_position
+                || (v1->approx_position == v2->approx_position && v1->mem.length() > v2->mem.length());
+        });
+    position_vertexes.reserve(sorted_vertexes.size());
+    for (size_t i = 0; i < sorted_vertexes.size(); ) {
+        size_t j = i;
+        approx_positions.push_back(sorted_vertexes[i]->approx_position);
+        position_starts.push_back(position_vertexes.size());
+        for ( ; j < sorted_vertexes.size() && sorted_vertexes[j]->approx_position == approx_positions.back(); ++j) {
+            if (j - i < (size_t)position_depth) {
+                position_vertexes.push_back(sorted_vertexes[j]);
+            } else {
+                sorted_vertexes[j]->redundant = true;
             }
         }
-        pos.second.resize(min(pos.second.size(), (size_t)position_depth));
+        i = j;
     }
-    // for each vertex merge if we go equivalently forward in the positional space and forward in the read to the next position
-    // scan forward
-    for (map<int, vector<vector<MEMChainModelVertex>::iterator> >::iterator p = approx_positions.begin();
-         p != approx_positions.end(); ++p) {
-        for (auto& v1 : p->second) {
-            if (redundant_vertexes.count(v1)) continue;
-            auto q = p;
-            while (++q != approx_positions.end() && abs(p->first - q->first) < band_width) {
-                for (auto& v2 : q->second) {
-                    if (redundant_vertexes.count(v2)) continue;
-                    if (mems_overlap(v1->mem, v2->mem)
-                        && abs(v2->mem.begin - v1->mem.begin) == abs(q->first - p->first)) {
-                        if (v2->mem.length() < v1->mem.length()) {
-                            redundant_vertexes.insert(v2);
-                            if (v2->mem.end > v1->mem.end) {
-                                v1->weight += v2->mem.end - v1->mem.end;
-                            }
+    position_starts.push_back(position_vertexes.size());
+    
+    // vertexes at the ith approx position
+    auto vertexes_at = [&](size_t i) {
+        return make_pair(position_vertexes.begin() + position_starts[i],
+                         position_vertexes.begin() + position_starts[i + 1]);
+    };
+    
+    // for each vertex merge if we go equivalently forward in the positional
+    // space and forward in the read to the next position
+    auto merge_in_line = [&](size_t p, size_t q) {
+        auto vs1 = vertexes_at(p);
+        auto vs2 = vertexes_at(q);
+        for (auto v1 = vs1.first; v1 != vs1.second; ++v1) {
+            if ((*v1)->redundant) continue;
+            for (auto v2 = vs2.first; v2 != vs2.second; ++v2) {
+                if ((*v2)->redundant) continue;
+                if (mems_overlap((*v1)->mem, (*v2)->mem)
+                    && abs((*v2)->mem.begin - (*v1)->mem.begin) == abs(approx_positions[q] - approx_positions[p])) {
+                    if ((*v2)->mem.length() < (*v1)->mem.length()) {
+                        (*v2)->redundant = true;
+                        if ((*v2)->mem.end > (*v1)->mem.end) {
+                            (*v1)->weight += (*v2)->mem.end - (*v1)->mem.end;
                         }
                     }
                 }
             }
         }
+    };
+    // scan forward
+    for (size_t p = 0; p < approx_positions.size(); ++p) {
+        for (size_t q = p + 1; q < approx_positions.size()
+                 && abs(approx_positions[p] - approx_positions[q]) < band_width; ++q) {
+            merge_in_line(p, q);
+        }
     }
     // scan reverse
-    for (map<int, vector<vector<MEMChainModelVertex>::iterator> >::reverse_iterator p = approx_positions.rbegin();
-         p != approx_positions.rend(); ++p) {
-        for (auto& v1 : p->second) {
-            if (redundant_vertexes.count(v1)) continue;
-            auto q = p;
-            while (++q != approx_positions.rend() && abs(p->first - q->first) < band_width) {
-                for (auto& v2 : q->second) {
-                    if (redundant_vertexes.count(v2)) continue;
-                    if (mems_overlap(v1->mem, v2->mem)
-                        && abs(v2->mem.begin - v1->mem.begin) == abs(p->first - q->first)) {
-                        if (v2->mem.length() < v1->mem.length()) {
-                            redundant_vertexes.insert(v2);
-                            if (v2->mem.end > v1->mem.end) {
-                                v1->weight += v2->mem.end - v1->mem.end;
-                            }
-                        }
-                    }
-                }
-            }
+    for (size_t p = approx_positions.size(); p-- > 0; ) {
+        for (size_t q = p; q-- > 0 && abs(approx_positions[p] - approx_positions[q]) < band_width; ) {
+            merge_in_line(p, q);
         }
     }
     // now build up the model using the positional bandwidth
-    for (map<int, vector<vector<MEMChainModelVertex>::iterator> >::iterator p = approx_positions.begin();
-         p != approx_positions.end(); ++p) {
-        // look bandwidth before and bandwidth after in the approx positions
-        // after
-        for (auto& v1 : p->second) {
-            if (redundant_vertexes.count(v1)) continue;
-            auto q = p;
-            while (++q != approx_positions.end() && abs(p->first - q->first) < band_width) {
-                for (auto& v2 : q->second) {
-                    if (redundant_vertexes.count(v2)) continue;
+    for (size_t p = 0; p < approx_positions.size(); ++p) {
+        // look bandwidth after in the approx positions
+        auto vs1 = vertexes_at(p);
+        for (auto i1 = vs1.first; i1 != vs1.second; ++i1) {
+            MEMChainModelVertex* v1 = *i1;
+            if (v1->redundant) continue;
+            for (size_t q = p + 1; q < approx_positions.size()
+                     && abs(approx_positions[p] - approx_positions[q]) < band_width; ++q) {
+                auto vs2 = vertexes_at(q);
+                for (auto i2 = vs2.first; i2 != vs2.second; ++i2) {
+                    MEMChainModelVertex* v2 = *i2;
+                    if (v2->redundant) continue;
                     // if this is an allowable transition, run the weighting function on it
                     if (v1->next_cost.size() < max_connections
                         && v2->prev_cost.size() < max_connections) {
@@ -4335,15 +4858,15 @@ MEMChainModel::MEMChainModel(
                             || v1->mem.fragment == v2->mem.fragment && v1->mem.begin < v2->mem.begin) {
                             double weight = transition_weight(v1->mem, v2->mem);
                             if (weight > -std::numeric_limits<double>::max()) {
-                                v1->next_cost.push_back(make_pair(&*v2, weight));
-                                v2->prev_cost.push_back(make_pair(&*v1, weight));
+                                v1->next_cost.push_back(make_pair(v2, weight));
+                                v2->prev_cost.push_back(make_pair(v1, weight));
                             }
                         } else if (v1->mem.fragment > v2->mem.fragment
                                    || v1->mem.fragment == v2->mem.fragment && v1->mem.begin > v2->mem.begin) {
                             double weight = transition_weight(v2->mem, v1->mem);
                             if (weight > -std::numeric_limits<double>::max()) {
-                                v2->next_cost.push_back(make_pair(&*v1, weight));
-                                v1->prev_cost.push_back(make_pair(&*v2, weight));
+                                v2->next_cost.push_back(make_pair(v1, weight));
+                                v1->prev_cost.push_back(make_pair(v2, weight));
                             }
                         }
                     }
@@ -4353,11 +4876,11 @@ MEMChainModel::MEMChainModel(
     }
 }
 
-void MEMChainModel::score(const set<MEMChainModelVertex*>& exclude) {
+void MEMChainModel::score(void) {
     // propagate the scores in the model
     for (auto& m : model) {
         // score is equal to the max inbound + mem.weight
-        if (exclude.count(&m)) continue; // skip if vertex was whole cluster
+        if (m.excluded) continue; // skip if vertex was whole cluster
         m.score = m.weight;
         for (auto& p : m.prev_cost) {
             if (p.first == nullptr) continue; // this transition is masked out
@@ -4390,12 +4913,11 @@ void MEMChainModel::clear_scores(void) {
 vector<vector<MaximalExactMatch> > MEMChainModel::traceback(int alt_alns, bool paired, bool debug) {
     vector<vector<MaximalExactMatch> > traces;
     traces.reserve(alt_alns); // avoid reallocs so we can refer to pointers to the traces
-    set<MEMChainModelVertex*> exclude;
-    for (auto& v : redundant_vertexes) exclude.insert(&*v);
+    for (auto& v : model) v.excluded = v.redundant;
     for (int i = 0; i < alt_alns; ++i) {
         // score the model, accounting for excluded traces
         clear_scores();
-        score(exclude);
+        score();
 #ifdef debug_mapper
 #pragma omp critical
         {
@@ -4429,16 +4951,19 @@ vector<vector<MaximalExactMatch> > MEMChainModel::traceback(int alt_alns, bool p
         }
         // if we have a singular match or reads are not paired, record not to use it again
         if (paired && vertex_trace.size() == 1) {
-            exclude.insert(vertex_trace.front());
+            vertex_trace.front()->excluded = true;
         }
         // fill this out when we're paired to help mask out in-fragment transitions
-        set<MEMChainModelVertex*> chain_members;
-        if (paired) for (auto v : vertex_trace) chain_members.insert(v);
+        vector<MEMChainModelVertex*> chain_members;
+        if (paired) {
+            chain_members = vertex_trace;
+            std::sort(chain_members.begin(), chain_members.end());
+        }
         traces.emplace_back();
         auto& mem_trace = traces.back();
         for (auto v = vertex_trace.rbegin(); v != vertex_trace.rend(); ++v) {
             auto& vertex = **v;
-            if (!paired) exclude.insert(&vertex);
+            if (!paired) vertex.excluded = true;
             if (v != vertex_trace.rbegin()) {
                 auto y = v - 1;
                 MEMChainModelVertex* prev = *y;
@@ -4448,7 +4973,7 @@ vector<vector<MaximalExactMatch> > MEMChainModel::traceback(int alt_alns, bool p
                         p.first = nullptr;
                     } else if (paired && p.first != nullptr
                                && p.first->mem.fragment != vertex.mem.fragment
-                               && chain_members.count(p.first)) {
+                               && std::binary_search(chain_members.begin(), chain_members.end(), p.first)) {
                         p.first = nullptr;
                     }
                 }
@@ -5,11 +5,15 @@
 #include <map>
 #include <chrono>
 #include <ctime>
+#include <atomic>
+#include <mutex>
 #include "vg.hpp"
 #include "xg.hpp"
 #include "index.hpp"
 #include "gcsa/gcsa.h"
 #include "gcsa/lcp.h"
+#include "kmer_range_table.hpp"
+#include "distance_index.hpp"
 #include "alignment.hpp"
 #include "path.hpp"
 #include "position.hpp"
@@ -80,6 +84,10 @@ public:
     double score;
     int approx_position;
     MEMChainModelVertex* prev;
+    // true if a longer MEM at (or in line with) this position covers this one
+    bool redundant = false;
+    // true if this vertex may not be used in the chain being traced back
+    bool excluded = false;
     MEMChainModelVertex(void) = default;                                      // Copy constructor
     MEMChainModelVertex(const MEMChainModelVertex&) = default;               // Copy constructor
     MEMChainModelVertex(MEMChainModelVertex&&) = default;                    // Move constructor
@@ -91,8 +99,12 @@ public:
 class MEMChainModel {
 public:
     vector<MEMChainModelVertex> model;
-    map<int, vector<vector<MEMChainModelVertex>::iterator> > approx_positions;
-    set<vector<MEMChainModelVertex>::iterator> redundant_vertexes;
+    // the distinct approximate positions of the vertexes, in sorted order
+    vector<int> approx_positions;
+    // the vertexes kept at each approximate position, longest MEM first, are
+    // position_vertexes[position_starts[i]] to position_vertexes[position_starts[i+1]-1]
+    vector<size_t> position_starts;
+    vector<MEMChainModelVertex*> position_vertexes;
     MEMChainModel(
         const vector<size_t>& aln_lengths,
         const vector<vector<MaximalExactMatch> >& matches,
@@ -101,13 +113,79 @@ public:
         int band_width = 10,
         int position_depth = 1,
         int max_connections = 10);
-    void score(const set<MEMChainModelVertex*>& exclude);
+    void score(void);
     MEMChainModelVertex* max_vertex(void);
     vector<vector<MaximalExactMatch> > traceback(int alt_alns, bool paired, bool debug);
     void display(ostream& out);
     void clear_scores(void);
 };
 
+/**
+ * A fragment length distribution learned from read pairs, which the Mappers
+ * for different threads can share, so that they learn it together instead of
+ * each from scratch.
+ */
+class FragmentLengthModel {
+public:
+    /// Record the configuration of a consistently mapped pair. Every
+    /// estimate_interval records, re-estimate the distribution from the last
+    /// cache_size of them, capping fragment size at sigma standard deviations
+    /// above the mean.
+    void record(double length, bool same_orientation, bool same_direction,
+                int cache_size, int estimate_interval, double sigma);
+    /// Replace the estimate, as when loading one learned earlier.
+    void set_estimate(int fragment_size, double mean, double stdev, bool orientation, bool direction);
+    /// Get the current estimate, and return its version.
+    uint64_t get_estimate(int& fragment_size, double& mean, double& stdev, bool& orientation, bool& direction);
+    /// Goes up every time the estimate changes, and is 0 while there isn't
+    /// one. Cheap enough to check for every pair.
+    uint64_t version(void) const;
+
+private:
+    mutex model_mutex;
+    deque<double> lengths;
+    deque<bool> orientations;
+    deque<bool> directions;
+    int since_last_estimate = 0;
+    int fragment_size = 0;
+    double mean = 0;
+    double stdev = 0;
+    bool orientation = false;
+    bool direction = true;
+    atomic<uint64_t> estimate_version{0};
+};
+
+/**
+ * Counts of how far reads get through the stages of MEM alignment: seeding,
+ * chaining, acceptance of perfect matches or ungapped extensions without
+ * dynamic programming, and dynamic programming. Each Mapper keeps its own,
+ * so counting costs only an increment, and the counts from all the threads
+ * are added up at the end.
+ */
+struct MapperStageStats {
+    /// Reads we looked for MEMs in
+    size_t reads = 0;
+    /// Reads that had any MEMs
+    size_t seeded = 0;
+    /// Clusters produced by chaining
+    size_t chained = 0;
+    /// Clusters accepted as a perfect match, without dynamic programming
+    size_t exact = 0;
+    /// Clusters accepted as an ungapped extension of a MEM, without dynamic
+    /// programming
+    size_t ungapped = 0;
+    /// Clusters that needed dynamic programming
+    size_t aligned = 0;
+    /// Clusters never aligned because the read was accepted early
+    size_t skipped = 0;
+    /// Reads accepted before all of their clusters were aligned
+    size_t accepted_early = 0;
+
+    MapperStageStats& operator+=(const MapperStageStats& other);
+    /// Write the counts out, one stage per line
+    void print(ostream& out) const;
+};
+
 
 class Mapper {
 
@@ -172,6 +250,10 @@ private:
                                          vector<pair<MaximalExactMatch, vector<size_t> > >::iterator sub_mem_records_begin,
                                          vector<pair<MaximalExactMatch, vector<size_t> > >::iterator sub_mem_records_end);
     
+    // fills in the nodes of all the given MEMs, locating their GCSA ranges together in
+    // suffix array order and collecting the hits in one buffer
+    void locate_mems(const vector<MaximalExactMatch*>& mems);
+    
     // fills a vector where each element contains the set of positions in the graph that the
     // MEM touches at that index for the first MEM hit in the GCSA array
     void first_hit_positions_by_index(MaximalExactMatch& mem,
@@ -196,6 +278,14 @@ public:
     // GCSA index and its LCP array
     gcsa::GCSA* gcsa;
     gcsa::LCPArray* lcp;
+    // optional table of the GCSA ranges of short k-mers, to start MEM
+    // searches from
+    KmerRangeTable* kmer_ranges = nullptr;
+    // optional index of exact distances over the snarl tree, to answer
+    // distance queries without walking the graph
+    DistanceIndex* distance_index = nullptr;
+    // how far the reads we've mapped got through the stages of alignment
+    MapperStageStats stage_stats;
     // GSSW aligner(s)
     vector<QualAdjAligner*> qual_adj_aligners;
     vector<Aligner*> regular_aligners;
@@ -242,6 +332,13 @@ public:
     bool cached_fragment_direction;
     int since_last_fragment_length_estimate;
     int fragment_length_estimate_interval;
+    // if set, learn the fragment length distribution in this model, along with
+    // any other Mappers sharing it, instead of on our own
+    FragmentLengthModel* shared_fragment_model = nullptr;
+    // the version of the shared model's estimate we're using
+    uint64_t shared_fragment_version = 0;
+    // pick up the shared model's estimate, if it has changed
+    void update_fragment_estimate(void);
 
     double estimate_gc_content(void);
     int random_match_length(double chance_random);
@@ -289,8 +386,23 @@ public:
     VG cluster_subgraph(const Alignment& aln, const vector<MaximalExactMatch>& mems);
     // helper to cluster subgraph
     void cached_graph_context(VG& graph, const pos_t& pos, int length, LRUCache<id_t, Node>& node_cache, LRUCache<id_t, vector<Edge> >& edge_cache);
-    // for aligning to a particular MEM cluster
+    // for aligning to a particular MEM cluster, by the cheapest stage that can give the best alignment
     Alignment align_cluster(const Alignment& aln, const vector<MaximalExactMatch>& mems);
+    // if one of the cluster's MEMs covers the whole read, walk the perfect alignment it gives, or else return one without a path
+    Alignment align_cluster_exactly(const Alignment& aln, const vector<MaximalExactMatch>& mems);
+    // if extending the cluster's longest MEM through the graph without gaps gives an alignment within
+    // max_ungapped_loss of a perfect match, return it, or else return one without a path
+    Alignment align_cluster_ungapped(const Alignment& aln, const vector<MaximalExactMatch>& mems);
+    // walk seq[i..] through the graph from pos without gaps, keeping the walk with the fewest mismatches
+    // in best_walk if it has fewer than best_mismatches, and giving up after budget steps
+    void extend_ungapped(const string& seq, size_t i, pos_t pos, int mismatches, vector<pos_t>& walk,
+                         vector<pos_t>& best_walk, int& best_mismatches, size_t& budget);
+    // the score of the read aligned as a perfect match, which no alignment can beat
+    int32_t perfect_score(const Alignment& aln);
+    // an upper bound on the score of any alignment of the read to the cluster, given all the read's MEMs and
+    // the longest MEMs we looked for
+    int32_t cluster_score_bound(const Alignment& aln, const vector<MaximalExactMatch>& cluster,
+                                const vector<MaximalExactMatch>& mems, int max_mem_length);
     // compute the uniqueness metric based on the MEMs in the cluster
     double compute_uniqueness(const Alignment& aln, const vector<MaximalExactMatch>& mems);
     // wraps align_to_graph with flipping
@@ -352,6 +464,16 @@ public:
                                 bool& path_reverse,
                                 int window);
 
+    // If the alignment already lies entirely along exactly one of the given
+    // paths, visiting each node once in a consistent orientation, find where
+    // it falls on that path without realigning and return true. Otherwise
+    // return false and leave the outputs alone.
+    bool surject_by_projection(const Alignment& source,
+                               const set<string>& path_names,
+                               string& path_name,
+                               int64_t& path_pos,
+                               bool& path_reverse);
+
     // MEM-based mapping
     // find maximal exact matches
     // These are SMEMs by definition when shorter than the max_mem_length or GCSA2 order.
@@ -382,9 +504,9 @@ public:
     double compute_cluster_mapping_quality(const vector<vector<MaximalExactMatch> >& clusters, int read_length);
     // use an average length of an LCP to a parent in the suffix tree to estimate a mapping quality
     double estimate_max_possible_mapping_quality(int length, double min_diffs, double next_min_diffs);
-    // walks the graph one base at a time from pos1 until we find pos2
+    // walks the graph one base at a time from pos1 until we find pos2, unless the distance index knows
     int graph_distance(pos_t pos1, pos_t pos2, int maximum = 1e3);
-    // use the offset in the sequence array to give an approximate distance
+    // use the distance index if we have one, or else the offset in the sequence array, to give an approximate distance
     int approx_distance(pos_t pos1, pos_t pos2);
     // use the offset in the sequence array to get an approximate position
     int approx_position(pos_t pos);
@@ -444,6 +566,8 @@ public:
     bool mem_chaining; // whether to use the mem threading mapper or not
     int mem_reseed_length; // the length above which we reseed MEMs to get potentially missed hits
     bool fast_reseed; // use the fast reseed algorithm
+    int max_ungapped_loss; // accept ungapped extensions of MEMs scoring this close to a perfect match without DP
+                           // (if negative, anything that scores better than a single gap could)
 
     // general parameters, applying to both types of mapping
     //
@@ -36,6 +36,8 @@ PathIndex::PathIndex(const Path& path) {
     
     // Record the length of the last mapping, since there's no next mapping to work it out from
     last_node_length = path.mapping_size() > 0 ? mapping_from_length(path.mapping(path.mapping_size() - 1)) : 0;
+    
+    compact();
 
 #ifdef debug    
     // Announce progress.
@@ -134,6 +136,8 @@ PathIndex::PathIndex(const list<Mapping>& mappings, VG& vg) {
     // Create the actual reference sequence we will use
     sequence = seq_stream.str();
     
+    compact();
+    
 #ifdef debug
     // Announce progress.
     #pragma omp critical (cerr)
@@ -236,6 +240,8 @@ PathIndex::PathIndex(const Path& path, const xg::XG& index) {
     // Create the actual reference sequence we will use
     sequence = seq_stream.str();
     
+    compact();
+    
 #ifdef debug
     // Announce progress.
     #pragma omp critical (cerr)
@@ -296,7 +302,79 @@ void PathIndex::update_mapping_positions(VG& vg, const string& path_name) {
     }
 }
 
+void PathIndex::compact() {
+    node_starts.clear();
+    node_sides.clear();
+    node_starts.reserve(by_start.size());
+    node_sides.reserve(by_start.size());
+    for (auto& kv : by_start) {
+        node_starts.push_back(kv.first);
+        node_sides.push_back(kv.second);
+    }
+    tables_last_length = last_node_length;
+    vector<bool>().swap(divided);
+    tables_current = true;
+}
+
+bool PathIndex::tables_exact() const {
+    return tables_current && divided.empty();
+}
+
+size_t PathIndex::find_occurrence(size_t position) const {
+    assert(tables_current);
+    assert(!node_starts.empty());
+    
+    // Find whatever starts after here
+    auto starts_next = upper_bound(node_starts.begin(), node_starts.end(), position);
+    
+    // This can't work if we try to look before the first node.
+    assert(starts_next != node_starts.begin());
+    
+    // Walk one back, to the node that has to own the position we asked about.
+    size_t occurrence = (starts_next - node_starts.begin()) - 1;
+    
+    // Make sure we didn't fall off the ends
+    assert(position - node_starts[occurrence] < occurrence_length(occurrence));
+    
+    return occurrence;
+}
+
+size_t PathIndex::occurrence_count() const {
+    assert(tables_exact());
+    return node_starts.size();
+}
+
+size_t PathIndex::next_occurrence(size_t position) const {
+    assert(tables_exact());
+    return lower_bound(node_starts.begin(), node_starts.end(), position) - node_starts.begin();
+}
+
+size_t PathIndex::occurrence_start(size_t occurrence) const {
+    assert(tables_exact());
+    return node_starts.at(occurrence);
+}
+
+NodeSide PathIndex::occurrence_side(size_t occurrence) const {
+    assert(tables_exact());
+    return node_sides.at(occurrence);
+}
+
+size_t PathIndex::occurrence_length(size_t occurrence) const {
+    if (occurrence + 1 == node_starts.size()) {
+        // We want the length of the last visit
+        return tables_last_length;
+    } else {
+        return node_starts[occurrence + 1] - node_starts[occurrence];
+    }
+}
+
 NodeSide PathIndex::at_position(size_t position) const {
+    if (tables_current) {
+        size_t occurrence = find_occurrence(position);
+        if (divided.empty() || !divided[occurrence]) {
+            return node_sides[occurrence];
+        }
+    }
     return find_position(position)->second;
 }
 
@@ -349,6 +427,29 @@ size_t PathIndex::node_length(const iterator& here) const {
 }
 
 pair<size_t, size_t> PathIndex::round_outward(size_t start, size_t past_end) const {
+    if (tables_current) {
+        // Use the flat tables, unless we land in an occurrence that has been
+        // divided up since they were built
+        size_t start_rounded;
+        size_t start_occurrence = find_occurrence(start);
+        if (divided.empty() || !divided[start_occurrence]) {
+            start_rounded = node_starts[start_occurrence];
+        } else {
+            start_rounded = find_position(start)->first;
+        }
+        size_t past_end_rounded = 0;
+        if (past_end != 0) {
+            size_t end_occurrence = find_occurrence(past_end - 1);
+            if (divided.empty() || !divided[end_occurrence]) {
+                past_end_rounded = node_starts[end_occurrence] + occurrence_length(end_occurrence);
+            } else {
+                auto found = find_position(past_end - 1);
+                past_end_rounded = found->first + node_length(found);
+            }
+        }
+        return make_pair(start_rounded, past_end_rounded);
+    }
+
     // Find the node occurrence the start position is on
     auto start_occurrence = find_position(start);
     // Seek to the start of that occurrence
@@ -477,7 +578,7 @@ void PathIndex::apply_translation(const Translation& translation) {
     }
 }
 
-void PathIndex::apply_translations(const vector<Translation>& translations) {
+bool PathIndex::apply_translations(const vector<Translation>& translations) {
     // Convert from normal to partitioning translations
     
     // For each original node ID, we keep a vector of pairs of from mapping and
@@ -503,6 +604,12 @@ void PathIndex::apply_translations(const vector<Translation>& translations) {
             continue;
         }
         
+        if (!node_occurrences.count(t.from().mapping(0).position().node_id())) {
+            // This node isn't on our path, so we don't need to touch anything
+            // (and in particular we can keep our mapping_positions cache).
+            continue;
+        }
+        
         // Stick the from and to mappings in the list for the from node
         collated[t.from().mapping(0).position().node_id()].push_back(make_pair(t.from().mapping(0), t.to().mapping(0)));
     }
@@ -536,6 +643,8 @@ void PathIndex::apply_translations(const vector<Translation>& translations) {
         // TODO: batch up a bit?
         apply_translation(covering);
     }
+    
+    return !collated.empty();
 }
 
 void PathIndex::replace_occurrence(iterator to_replace, const vector<Mapping>& replacements) {
@@ -553,6 +662,17 @@ void PathIndex::replace_occurrence(iterator to_replace, const vector<Mapping>& r
     auto comes_next = to_replace;
     comes_next++;
     
+    if (tables_current) {
+        // Translations only divide nodes, so the occurrence in the flat
+        // tables that holds this one still starts and ends in the same
+        // places. Flag it so lookups inside it go to by_start.
+        size_t occurrence = find_occurrence(start);
+        if (divided.empty()) {
+            divided.resize(node_starts.size(), false);
+        }
+        divided[occurrence] = true;
+    }
+    
     if (by_id.count(node_id) && by_id.at(node_id).first == start) {
         // We're removing the first occurrence of this node, so we need to
         // clean up by_id. But since we're removing all occurreences of this
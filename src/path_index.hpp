@@ -67,6 +67,32 @@ struct PathIndex {
     /// make it use a good datastructure instead of brute force.
     void update_mapping_positions(VG& vg, const string& path_name);
     
+    /// Rebuild the flat position tables from by_start. While they are current,
+    /// at_position() and round_outward() binary search contiguous arrays
+    /// instead of walking the map. The constructors call this. Applying
+    /// translations keeps the tables, and just flags the occurrences in them
+    /// that got divided, so lookups landing there go to by_start instead.
+    /// Calling this again folds those divisions into the tables.
+    void compact();
+    
+    /// Get the number of node occurrences on the path. The flat tables must be
+    /// current, with no divisions since they were built.
+    size_t occurrence_count() const;
+    
+    /// Get the index of the first node occurrence starting at or after the
+    /// given position, or occurrence_count() if there is none. The flat tables
+    /// must be current, with no divisions since they were built.
+    size_t next_occurrence(size_t position) const;
+    
+    /// Get the start position of the node occurrence with the given index.
+    size_t occurrence_start(size_t occurrence) const;
+    
+    /// Get the NodeSide visited by the node occurrence with the given index.
+    NodeSide occurrence_side(size_t occurrence) const;
+    
+    /// Get the length of the node occurrence with the given index.
+    size_t occurrence_length(size_t occurrence) const;
+    
     /// Find what node and orientation covers a position. The position must not
     /// be greater than the path length.
     NodeSide at_position(size_t position) const;
@@ -111,8 +137,11 @@ struct PathIndex {
      * vector may include both forward and reverse versions of each to node, and
      * may also include translations mapping nodes that did not change to
      * themselves.
+     *
+     * Returns true if any node on the indexed path was translated, and false
+     * if the index was left alone.
      */
-    void apply_translations(const vector<Translation>& translations);
+    bool apply_translations(const vector<Translation>& translations);
     
 protected:
 
@@ -120,6 +149,27 @@ protected:
     /// indexed path.
     size_t last_node_length;
     
+    /// Sorted start positions of all the node occurrences on the path, and the
+    /// NodeSides that occur there, built from by_start by compact().
+    vector<size_t> node_starts;
+    vector<NodeSide> node_sides;
+    /// Length of the last occurrence in the tables.
+    size_t tables_last_length = 0;
+    /// Whether node_starts and node_sides, apart from the divided occurrences,
+    /// agree with by_start.
+    bool tables_current = false;
+    /// Flags for the occurrences in the tables that translations have divided
+    /// since compact(), which must be looked up in by_start. Empty if there
+    /// are none.
+    vector<bool> divided;
+    
+    /// Find the index in the flat tables of the occurrence covering the given
+    /// position. The tables must be current.
+    size_t find_occurrence(size_t position) const;
+    
+    /// Return true if the flat tables describe every occurrence exactly.
+    bool tables_exact() const;
+    
     /// This holds all the places that a particular node occurs, in order.
     /// TODO: use this to replace by_id
     map<id_t, vector<iterator>> node_occurrences;
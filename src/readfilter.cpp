@@ -585,8 +585,14 @@ int ReadFilter::filter(istream* alignment_stream, xg::XG* xindex) {
     function<void(int, Alignment&, const vector<int>&)> update_buffers = [
         &buffer, &region_map, &get_chunks, &flush_buffer](int tid, Alignment& aln,
                                                           const vector<int>& aln_chunks) {
-        for (auto chunk : aln_chunks) {
-            buffer[tid][chunk].push_back(aln);
+        for (size_t i = 0; i < aln_chunks.size(); ++i) {
+            auto chunk = aln_chunks[i];
+            if (i + 1 == aln_chunks.size()) {
+                // nothing needs the alignment after its last copy, so move it
+                buffer[tid][chunk].push_back(std::move(aln));
+            } else {
+                buffer[tid][chunk].push_back(aln);
+            }
             if (buffer[tid][chunk].size() >= buffer_size) {
                 // flush buffer (could get fancier and allow parallel writes to different
                 // files, but unlikely to be worth effort as we're mostly trying to
@@ -599,15 +605,26 @@ int ReadFilter::filter(istream* alignment_stream, xg::XG* xindex) {
         }
     };
 
-    // keep counts of what's filtered to report (in verbose mode)
-    vector<Counts> counts_vec(threads);
-            
-    // we assume that every primary alignment has 0 or 1 secondary alignment
-    // immediately following in the stream
-    function<void(Alignment&)> lambda = [&](Alignment& aln) {
-        int tid = omp_get_thread_num();        
-        Counts& counts = counts_vec[tid];
-        bool keep = true;
+    // Compile the configured criteria into chains of predicates, cheapest
+    // first: single fields of the read, then the score arithmetic, then a
+    // look at the ends of the path, and after the region check, the scan of
+    // the read's ends for repeats and finally the xg lookups for split reads.
+    // Each returns true if the read should be dropped, and comes with the
+    // count it bumps when it does. Criteria that can't drop anything with the
+    // current settings are left out entirely.
+    typedef vector<size_t> Counts::* Counter;
+    typedef pair<function<bool(Alignment&)>, Counter> Criterion;
+    vector<Criterion> cheap_criteria;
+    vector<Criterion> costly_criteria;
+    
+    if (min_mapq > 0) {
+        // mapping qualities are never negative
+        cheap_criteria.emplace_back([&](Alignment& aln) {
+            return aln.mapping_quality() < min_mapq;
+        }, &Counts::min_mapq);
+    }
+    
+    cheap_criteria.emplace_back([&](Alignment& aln) {
         double score = (double)aln.score();
         double denom = 2. * aln.sequence().length();
         // toggle substitution score
@@ -626,6 +643,11 @@ int ReadFilter::filter(istream* alignment_stream, xg::XG* xindex) {
                 assert(score == 0.);
             }
         }
+        return (aln.is_secondary() && score < min_secondary) ||
+            (!aln.is_secondary() && score < min_primary);
+    }, &Counts::min_score);
+    
+    cheap_criteria.emplace_back([&](Alignment& aln) {
         // compute overhang
         int overhang = 0;
         if (aln.path().mapping_size() > 0) {
@@ -641,6 +663,44 @@ int ReadFilter::filter(istream* alignment_stream, xg::XG* xindex) {
         } else {
             overhang = aln.sequence().length();
         }
+        return overhang > max_overhang;
+    }, &Counts::max_overhang);
+    
+    if (repeat_size > 0) {
+        costly_criteria.emplace_back([&](Alignment& aln) {
+            return has_repeat(aln, repeat_size);
+        }, &Counts::repeat);
+    }
+    
+    if (drop_split) {
+        costly_criteria.emplace_back([&](Alignment& aln) {
+            return is_split(xindex, aln);
+        }, &Counts::split);
+    }
+    
+    // keep counts of what's filtered to report (in verbose mode)
+    vector<Counts> counts_vec(threads);
+    
+    // run a chain of criteria on an alignment, stopping as soon as one drops
+    // it unless we want to count everything
+    auto apply_criteria = [&](const vector<Criterion>& criteria, Alignment& aln,
+                              Counts& counts, int co, bool& keep) {
+        for (auto& criterion : criteria) {
+            if (!keep && !verbose) {
+                break;
+            }
+            if (criterion.first(aln)) {
+                ++(counts.*(criterion.second))[co];
+                keep = false;
+            }
+        }
+    };
+            
+    // we assume that every primary alignment has 0 or 1 secondary alignment
+    // immediately following in the stream
+    function<void(Alignment&)> lambda = [&](Alignment& aln) {
+        int tid = omp_get_thread_num();        
+        Counts& counts = counts_vec[tid];
 
         // offset in count tuples
         int co = aln.is_secondary() ? 1 : 0;
@@ -648,36 +708,18 @@ int ReadFilter::filter(istream* alignment_stream, xg::XG* xindex) {
         ++counts.read[co];
  
         // filter (current) alignment
-        keep = true;
-        if ((aln.is_secondary() && score < min_secondary) ||
-            (!aln.is_secondary() && score < min_primary)) {
-            ++counts.min_score[co];
-            keep = false;
-        }
-        if ((keep || verbose) && overhang > max_overhang) {
-            ++counts.max_overhang[co];
-            keep = false;
-        }
-        if ((keep || verbose) && aln.mapping_quality() < min_mapq) {
-            ++counts.min_mapq[co];
-            keep = false;
-        }
+        bool keep = true;
+        apply_criteria(cheap_criteria, aln, counts, co, keep);
 
         // do region check before heavier filters
         vector<int> aln_chunks;
         if (keep || verbose) {
             get_chunks(aln, aln_chunks);
-            keep = !aln_chunks.empty();
+            keep = keep && !aln_chunks.empty();
         }
         
-        if ((keep || verbose) && drop_split && is_split(xindex, aln)) {
-            ++counts.split[co];
-            keep = false;
-        }
-        if ((keep || verbose) && has_repeat(aln, repeat_size)) {
-            ++counts.repeat[co];
-            keep = false;
-        }
+        apply_criteria(costly_criteria, aln, counts, co, keep);
+        
         if ((keep || verbose) && defray_length && trim_ambiguous_ends(xindex, aln, defray_length)) {
             ++counts.defray[co];
             // We keep these, because the alignments get modified.
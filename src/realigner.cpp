@@ -1,20 +1,82 @@
 #include "realigner.hpp"
 
+#include <cstdio>
+#include <unistd.h>
+
 namespace vg {
 
+Realigner::Realigner(void) {
+    // Nothing to do until we have indexes
+}
+
+Realigner::~Realigner(void) {
+    clear();
+}
+
+void Realigner::clear(void) {
+    for (auto* mapper : mappers) {
+        delete mapper;
+    }
+    mappers.clear();
+    if (owns_indexes) {
+        delete xgidx;
+        delete gcsaidx;
+        delete lcpidx;
+    }
+    xgidx = nullptr;
+    gcsaidx = nullptr;
+    lcpidx = nullptr;
+    owns_indexes = false;
+}
 
-void Realigner::construct(void) {
+void Realigner::load(xg::XG* xg_index, gcsa::GCSA* gcsa_index, gcsa::LCPArray* lcp_index) {
+    clear();
+    xgidx = xg_index;
+    gcsaidx = gcsa_index;
+    lcpidx = lcp_index;
+    make_mappers();
+}
 
-    if (mapper) delete mapper;
-    if (xgidx) delete xgidx;
-    if (gcsaidx) delete gcsaidx;
-    if (lcpidx) delete lcpidx;
+string Realigner::cache_prefix(const string& cache_dir, const string& graph_hash) const {
+    // The indexing parameters change the GCSA2 index, so they are part of the key
+    stringstream prefix;
+    prefix << cache_dir << "/" << graph_hash
+           << "-k" << idx_kmer_size
+           << "-e" << edge_max
+           << "-S" << subgraph_prune
+           << "-X" << doubling_steps
+           << (idx_path_only ? "-P" : "");
+    return prefix.str();
+}
+
+void Realigner::construct(VG& graph, const string& cache_dir) {
+
+    clear();
+    owns_indexes = true;
+
+    string prefix;
+    if (!cache_dir.empty()) {
+        prefix = cache_prefix(cache_dir, graph.hash());
+        ifstream xg_in(prefix + ".xg");
+        ifstream gcsa_in(prefix + gcsa::GCSA::EXTENSION);
+        ifstream lcp_in(prefix + gcsa::GCSA::EXTENSION + ".lcp");
+        if (xg_in && gcsa_in && lcp_in) {
+            if (debug) cerr << "loading cached indexes from " << prefix << endl;
+            xgidx = new xg::XG(xg_in);
+            gcsaidx = new gcsa::GCSA();
+            gcsaidx->load(gcsa_in);
+            lcpidx = new gcsa::LCPArray();
+            lcpidx->load(lcp_in);
+            make_mappers();
+            return;
+        }
+    }
 
     if (debug) cerr << "building xg index" << endl;
-    xgidx = new xg::XG(graph->graph);
+    xgidx = new xg::XG(graph.graph);
     if (debug) cerr << "building GCSA2 index" << endl;
     if (edge_max) {
-        VG gcsa_graph = *graph; // copy the graph
+        VG gcsa_graph = graph; // copy the graph
         // remove complex components
         gcsa_graph.prune_complex_with_head_tail(idx_kmer_size, edge_max);
         if (subgraph_prune) gcsa_graph.prune_short_subgraphs(subgraph_prune);
@@ -22,52 +84,97 @@ void Realigner::construct(void) {
         gcsa_graph.build_gcsa_lcp(gcsaidx, lcpidx, idx_kmer_size, idx_path_only, false, doubling_steps);
     } else {
         // if no complexity reduction is requested, just build the index
-        graph->build_gcsa_lcp(gcsaidx, lcpidx, idx_kmer_size, idx_path_only, false, doubling_steps);
+        graph.build_gcsa_lcp(gcsaidx, lcpidx, idx_kmer_size, idx_path_only, false, doubling_steps);
+    }
+
+    if (!prefix.empty()) {
+        if (debug) cerr << "caching indexes under " << prefix << endl;
+        // Other runs may be looking at the cache at the same time, so write
+        // each index under a name unique to this process and then rename it
+        // into place. The xg goes last, since it is what readers check for.
+        string tmp_suffix = ".tmp" + to_string(getpid());
+        string xg_name = prefix + ".xg";
+        string gcsa_name = prefix + gcsa::GCSA::EXTENSION;
+        string lcp_name = gcsa_name + ".lcp";
+        {
+            ofstream xg_out(xg_name + tmp_suffix);
+            xgidx->serialize(xg_out);
+        }
+        bool stored = sdsl::store_to_file(*gcsaidx, gcsa_name + tmp_suffix)
+            && sdsl::store_to_file(*lcpidx, lcp_name + tmp_suffix);
+        if (!stored
+            || rename((gcsa_name + tmp_suffix).c_str(), gcsa_name.c_str()) != 0
+            || rename((lcp_name + tmp_suffix).c_str(), lcp_name.c_str()) != 0
+            || rename((xg_name + tmp_suffix).c_str(), xg_name.c_str()) != 0) {
+            // Caching is only an optimization, so carry on with what we built
+            cerr << "warning:[vg::Realigner] could not cache indexes under " << prefix << endl;
+            remove((xg_name + tmp_suffix).c_str());
+            remove((gcsa_name + tmp_suffix).c_str());
+            remove((lcp_name + tmp_suffix).c_str());
+        }
     }
-    mapper = new Mapper(xgidx, gcsaidx, lcpidx);
-    /*
-    // todo
-    { // set mapper variables
-        mapper->debug = debug_align;
-        mapper->context_depth = context_depth;
-        mapper->thread_extension = thread_extension;
-        mapper->max_attempts = max_attempts;
-        mapper->min_identity = min_identity;
-        mapper->alignment_threads = alignment_threads;
-        mapper->max_mem_length = max_mem_length;
-        mapper->min_mem_length = min_mem_length;
-        mapper->hit_max = hit_max;
-        mapper->greedy_accept = greedy_accept;
-        mapper->max_target_factor = max_target_factor;
-        mapper->max_multimaps = max_multimaps;
-        mapper->accept_identity = accept_identity;
-        mapper->match = match;
-        mapper->mismatch = mismatch;
-        mapper->gap_open = gap_open;
-        mapper->gap_extend = gap_extend;
+
+    make_mappers();
+}
+
+void Realigner::make_mappers(void) {
+    // Mappers keep per-alignment state, so each thread needs its own
+    while (mappers.size() < get_thread_count()) {
+        mappers.push_back(new Mapper(xgidx, gcsaidx, lcpidx));
     }
-    */
 }
 
-Alignment Realigner::realign(const Alignment& aln) {
-    assert(mapper != nullptr);
+bool Realigner::needs_realignment(const Alignment& aln) const {
+    return identity(aln.path()) < identity_trigger
+        || softclip_start(aln) + softclip_end(aln) >= softclip_trigger;
+}
+
+Alignment Realigner::realign(const Alignment& aln, Mapper& mapper) const {
     double ident = identity(aln.path());
     int softclip = softclip_start(aln) + softclip_end(aln);
-    if (ident < identity_trigger
-        || softclip >= softclip_trigger) {
-        auto alns = mapper[tid]->align_multi(aln);
-        auto& raln = alns.front();
-        double rident = identity(raln.path());
-        int rsoftclip = softclip_start(raln) + softclip_end(raln);
-        if (rident > ident || rsoftclip < softclip) {
-            return raln;
-        } else {
-            return aln;
-        }
+    auto alns = mapper.align_multi(aln);
+    auto& raln = alns.front();
+    double rident = identity(raln.path());
+    int rsoftclip = softclip_start(raln) + softclip_end(raln);
+    if (rident > ident || rsoftclip < softclip) {
+        return raln;
     } else {
         return aln;
     }
 }
 
+Alignment Realigner::realign(const Alignment& aln) {
+    assert(!mappers.empty());
+    if (!needs_realignment(aln)) {
+        return aln;
+    }
+    int tid = omp_get_thread_num();
+    assert(tid < mappers.size());
+    return realign(aln, *mappers[tid]);
+}
+
+void Realigner::realign(vector<Alignment>& alns) {
+    assert(!mappers.empty());
+    make_mappers();
+
+    // Find what needs doing, and order it by where it is in the graph
+    vector<pair<id_t, size_t>> todo;
+    for (size_t i = 0; i < alns.size(); ++i) {
+        if (needs_realignment(alns[i])) {
+            id_t first_node = alns[i].path().mapping_size() ?
+                alns[i].path().mapping(0).position().node_id() : 0;
+            todo.push_back(make_pair(first_node, i));
+        }
+    }
+    sort(todo.begin(), todo.end());
+
+    if (debug) cerr << "realigning " << todo.size() << " of " << alns.size() << " alignments" << endl;
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t j = 0; j < todo.size(); ++j) {
+        auto& aln = alns[todo[j].second];
+        aln = realign(aln, *mappers[omp_get_thread_num()]);
+    }
+}
 
 }
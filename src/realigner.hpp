@@ -13,81 +13,77 @@ namespace vg {
 
 using namespace std;
 
+/**
+ * Realigns alignments that look poor (low identity or heavily softclipped)
+ * against a graph, keeping the new alignment if it is better. The indexes
+ * used can be existing ones, or can be built from a graph, in which case they
+ * can be cached on disk under the graph's hash so later runs on the same
+ * graph don't have to build them again.
+ */
 class Realigner {
 
 public:
 
-    Realigner(vcflib::VariantCallFile& v,
-              FastaReference& r,
-              const string& t)
-        : reference(r)
-        , vcf_file(v)
-        , target(t)
-        , mapper(nullptr)
-        , gcsaidx(nullptr)
-        , lcpid(nullptr)
-        , xgidx(nullptr)
-        , identity_trigger(0.9)
-        , realign_unpaired(true)
-        , softclip_trigger(2)
-        , debug(false)
-        , idx_kmer_size(16)
-        , doubling_steps(3)
-        , edge_max(0)
-        , idx_path_only(false)
-        {
-            parse_region(target,
-                         seq_name,
-                         start_pos,
-                         end_pos);
-            construct();
-        }
-
-    FastaReference& ref;
-    vcflib::VariantCallFile vcf_file;
-    string target;
-    string seq_name;
-    int start_pos;
-    int end_pos;
-
-    bool debug;
-    double identity_trigger;
-    bool realign_unpaired;
-    double softclip_trigger;
-
-    int idx_kmer_size;
-    int edge_max;
-    bool idx_path_only;
-    int doubling_steps;
-
-    /*
-    // todo
-    int context_depth;
-    int thread_extension;
-    int max_attempts;
-    double min_identity;
-    int alignment_threads;
-    int max_mem_length;
-    int min_mem_length;
-    int hit_max;
-    bool greedy_accept;
-    bool max_target_factor;
-    int max_multimaps;
-    double accept_identity;
-    int match;
-    int mismatch;
-    int gap_open;
-    int gap_extend;
-    */
-
-    Mapper* mapper;
-    gcsa::GCSA* gcsaidx;
-    gcsa::LCPArray* lcpidx;
-    xg::XG* xgidx;
-
-    void construct(void);
+    Realigner(void);
+    ~Realigner(void);
+
+    bool debug = false;
+    /// Realign alignments with less than this identity
+    double identity_trigger = 0.9;
+    /// Realign alignments with at least this many softclipped bases
+    double softclip_trigger = 2;
+
+    /// Parameters used when building a GCSA2 index in construct()
+    int idx_kmer_size = 16;
+    int edge_max = 0;
+    int subgraph_prune = 0;
+    bool idx_path_only = false;
+    int doubling_steps = 3;
+
+    /// Use existing indexes, which the Realigner does not take ownership of.
+    void load(xg::XG* xg_index, gcsa::GCSA* gcsa_index, gcsa::LCPArray* lcp_index);
+
+    /// Index the given graph. If cache_dir is not empty, look there for
+    /// indexes already built for an identical graph with the same indexing
+    /// parameters, and save the indexes there if they have to be built.
+    void construct(VG& graph, const string& cache_dir = "");
+
+    /// Get the name that construct() caches indexes for the given graph hash
+    /// under, with the current indexing parameters. The xg index is saved as
+    /// <prefix>.xg, and the GCSA2 and LCP indexes are saved next to it.
+    string cache_prefix(const string& cache_dir, const string& graph_hash) const;
+
+    /// Returns true if the alignment trips one of the realignment triggers.
+    bool needs_realignment(const Alignment& aln) const;
+
+    /// Realign one alignment, if it needs it, using the calling thread's
+    /// Mapper. Returns the better of the original and the realignment.
     Alignment realign(const Alignment& aln);
 
+    /// Realign all of the alignments in the batch that need it, in parallel,
+    /// replacing them in place when the realignment is better. Alignments are
+    /// visited in order of the first node they touch, so threads work on
+    /// nearby parts of the graph together.
+    void realign(vector<Alignment>& alns);
+
+private:
+
+    /// Drop our mappers, and any indexes we own.
+    void clear(void);
+
+    /// Make sure we have a Mapper for every thread.
+    void make_mappers(void);
+
+    /// Realign with the given mapper, assuming the alignment trips a trigger.
+    Alignment realign(const Alignment& aln, Mapper& mapper) const;
+
+    vector<Mapper*> mappers;
+    xg::XG* xgidx = nullptr;
+    gcsa::GCSA* gcsaidx = nullptr;
+    gcsa::LCPArray* lcpidx = nullptr;
+    /// True if we built or loaded the indexes ourselves
+    bool owns_indexes = false;
+
 };
 
 }
@@ -3,6 +3,13 @@
 
 namespace vg {
 
+void Sampler::set_read_seed(int seed, size_t read_index) {
+    seed_seq seeds{(uint32_t) seed, (uint32_t) read_index, (uint32_t) (read_index >> 32)};
+    rng.seed(seeds);
+    // Names are made from the nonce, so it has to be deterministic too
+    nonce = read_index;
+}
+
 pos_t Sampler::position(void) {
     uniform_int_distribution<size_t> xdist(1, xgidx->seq_length);
     size_t offset = xdist(rng);
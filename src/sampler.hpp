@@ -53,6 +53,11 @@ public:
         rng.seed(seed);
     }
 
+    /// Reset the random state to one determined only by the given seed and
+    /// the index of the read about to be sampled. Reads sampled this way come
+    /// out the same whichever Sampler (or thread) makes them.
+    void set_read_seed(int seed, size_t read_index);
+
     pos_t position(void);
     string sequence(size_t length);
     Alignment alignment(size_t length);
@@ -54,12 +54,22 @@ pair<size_t, size_t> Simplifier::simplify_once(size_t iteration) {
         cerr << "Found " << leaves.size() << " leaves" << endl;
     }
     
-    // Index all the graph paths
-    map<string, unique_ptr<PathIndex>> path_indexes;
+    // Index all the graph paths. Indexing only reads the graph, so we can do
+    // all the paths at once.
+    vector<string> path_names;
     graph.paths.for_each_name([&](const string& name) {
-        // For every path name, go index it and put it in this collection
-        path_indexes.insert(make_pair(name, move(unique_ptr<PathIndex>(new PathIndex(graph, name)))));
+        path_names.push_back(name);
     });
+    vector<unique_ptr<PathIndex>> built_indexes(path_names.size());
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < path_names.size(); i++) {
+        built_indexes[i] = unique_ptr<PathIndex>(new PathIndex(graph, path_names[i]));
+    }
+    map<string, unique_ptr<PathIndex>> path_indexes;
+    for (size_t i = 0; i < path_names.size(); i++) {
+        // Put each index in this collection under its path name
+        path_indexes.insert(make_pair(path_names[i], move(built_indexes[i])));
+    }
     
     // Now we have a list of all the leaf sites.
     create_progress("simplifying leaves", leaves.size());
@@ -76,15 +86,27 @@ pair<size_t, size_t> Simplifier::simplify_once(size_t iteration) {
     // not work if we modify the graph.
     map<const Snarl*, vector<SnarlTraversal>> leaf_traversals;
     
-    for (const Snarl* leaf : leaves) {
+    // Make all the map entries up front, so the leaves can then be examined in
+    // parallel, each thread filling in its own leaves' entries. Nothing in the
+    // graph changes until they are all done.
+    vector<const Snarl*> leaf_vector(leaves.begin(), leaves.end());
+    for (const Snarl* leaf : leaf_vector) {
+        leaf_contents[leaf];
+        leaf_sizes[leaf] = 0;
+        leaf_traversals[leaf];
+    }
+    
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < leaf_vector.size(); i++) {
         // Look at all the leaves
+        const Snarl* leaf = leaf_vector[i];
         
         // Get the contents of the bubble, excluding the boundary nodes
-        leaf_contents[leaf] = site_manager.deep_contents(leaf, graph, false);
+        leaf_contents.at(leaf) = site_manager.deep_contents(leaf, graph, false);
         
         // For each leaf, calculate its total size.
-        unordered_set<Node*>& nodes = leaf_contents[leaf].first;
-        size_t& total_size = leaf_sizes[leaf];
+        unordered_set<Node*>& nodes = leaf_contents.at(leaf).first;
+        size_t& total_size = leaf_sizes.at(leaf);
         for (Node* node : nodes) {
             // For each node include it in the size figure
             total_size += node->sequence().size();
@@ -103,7 +125,7 @@ pair<size_t, size_t> Simplifier::simplify_once(size_t iteration) {
         
         // Identify the replacement traversal for the bubble if it's the right size.
         // We can't necessarily do this after we've modified the graph.
-        vector<SnarlTraversal>& traversals = leaf_traversals[leaf];
+        vector<SnarlTraversal>& traversals = leaf_traversals.at(leaf);
         traversals = traversal_finder.find_traversals(*leaf);
     }
     
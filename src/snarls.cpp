@@ -5,22 +5,46 @@
 
 #include "snarls.hpp"
 #include "json2pb.h"
+#include "stream.hpp"
 
 namespace vg {
+    const size_t SnarlManager::no_snarl;
+    
+    SnarlManager::SnarlManager(istream& in) {
+        // load snarls from the stream into the master list
+        function<void(Snarl&)> lambda = [&](Snarl& snarl) {
+            snarls.push_back(snarl);
+        };
+        stream::for_each(in, lambda);
+        // record the tree structure and build the other indexes
+        build_indexes();
+    }
+    
     const vector<const Snarl*>& SnarlManager::children_of(const Snarl* snarl) {
-        return children[key_form(snarl)];
+        size_t number = number_of(snarl);
+        if (number == no_snarl) {
+            // we don't know about this snarl, so it has no children we manage
+            static const vector<const Snarl*> no_children;
+            return no_children;
+        }
+        return children[number];
     }
     
     const Snarl* SnarlManager::parent_of(const Snarl* snarl) {
-        return parent[key_form(snarl)];
+        size_t number = number_of(snarl);
+        return number == no_snarl ? nullptr : parent[number];
     }
     
     bool SnarlManager::is_leaf(const Snarl* snarl) {
-        return children[key_form(snarl)].size() == 0;
+        return children_of(snarl).size() == 0;
     }
     
     bool SnarlManager::is_root(const Snarl* snarl) {
-        return parent[key_form(snarl)] == nullptr;
+        return parent_of(snarl) == nullptr;
+    }
+    
+    size_t SnarlManager::num_snarls() const {
+        return snarls.size();
     }
     
     const vector<const Snarl*>& SnarlManager::top_level_snarls() {
@@ -68,19 +92,78 @@ namespace vg {
         to_flip.mutable_end()->set_node_id(start_id);
         to_flip.mutable_end()->set_backward(!start_orientation);
         
-        // update parent index
-        parent[key_form(snarl)] = parent[old_key];
-        parent.erase(old_key);
-        
-        // update children index
-        children[key_form(snarl)] = std::move(children[old_key]);
-        children.erase(old_key);
-        
-        // Update index index
+        // Update index index (the tree arrays are indexed by position in the
+        // master list, and the inward-facing boundary traversals of a flipped
+        // snarl are the same as before, so nothing else needs to change)
         index_of[key_form(snarl)] = std::move(index_of[old_key]);
         index_of.erase(old_key);
     }
     
+    const Snarl* SnarlManager::into_which_snarl(id_t id, bool backward) {
+        auto found = boundary_index.find(make_pair(id, backward));
+        return found == boundary_index.end() ? nullptr : &snarls[found->second];
+    }
+    
+    const Snarl* SnarlManager::into_which_snarl(const Visit& visit) {
+        if (!visit.has_snarl()) {
+            return into_which_snarl(visit.node_id(), visit.backward());
+        }
+        // Unlike manage(), a snarl we don't have isn't an error here
+        auto found = index_of.find(key_form(&visit.snarl()));
+        return found == index_of.end() ? nullptr : &snarls[found->second];
+    }
+    
+    void SnarlManager::index_node_contents(VG& graph) {
+        
+        // find the nodes that each snarl owns directly, in parallel
+        vector<vector<id_t>> owned_nodes(snarls.size());
+#pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < snarls.size(); i++) {
+            for (Node* node : shallow_contents(&snarls[i], graph, false).first) {
+                owned_nodes[i].push_back(node->id());
+            }
+        }
+        
+        // shallow contents skip over the interiors of child snarls, so the
+        // snarl that owns a node directly is the innermost one containing it
+        node_index.clear();
+        for (size_t i = 0; i < snarls.size(); i++) {
+            for (id_t node_id : owned_nodes[i]) {
+                node_index[node_id] = i;
+            }
+        }
+    }
+    
+    const Snarl* SnarlManager::innermost_snarl_containing(id_t node_id) {
+        auto found = node_index.find(node_id);
+        return found == node_index.end() ? nullptr : &snarls[found->second];
+    }
+    
+    void SnarlManager::serialize(ostream& out) {
+        
+        vector<Snarl> buffer;
+        list<const Snarl*> stack;
+        
+        for (const Snarl* root : roots) {
+            stack.push_back(root);
+            
+            while (!stack.empty()) {
+                const Snarl* snarl = stack.back();
+                stack.pop_back();
+                
+                // write parents before their children
+                buffer.push_back(*snarl);
+                stream::write_buffered(out, buffer, 100);
+                
+                for (const Snarl* child : children_of(snarl)) {
+                    stack.push_back(child);
+                }
+            }
+        }
+        // flush
+        stream::write_buffered(out, buffer, 0);
+    }
+    
     map<NodeTraversal, const Snarl*> SnarlManager::child_boundary_index(const Snarl* snarl, VG& graph) {
         map<NodeTraversal, const Snarl*> index;
         for (const Snarl* child : children_of(snarl)) {
@@ -112,41 +195,47 @@ namespace vg {
                          make_pair(snarl->end().node_id(), snarl->end().backward()));
     }
     
+    inline size_t SnarlManager::number_of(const Snarl* snarl) {
+        // pointers into the master list can be resolved without hashing
+        std::less<const Snarl*> before;
+        if (!snarls.empty() && !before(snarl, snarls.data()) && before(snarl, snarls.data() + snarls.size())) {
+            return snarl - snarls.data();
+        }
+        auto found = index_of.find(key_form(snarl));
+        return found == index_of.end() ? no_snarl : found->second;
+    }
+    
     void SnarlManager::build_indexes() {
         
+        children.assign(snarls.size(), vector<const Snarl*>());
+        parent.assign(snarls.size(), nullptr);
+        
         for (size_t i = 0; i < snarls.size(); i++) {
             Snarl& snarl = snarls[i];
             
             // Remember where each snarl is
             index_of[key_form(&snarl)] = i;
+            
+            // Remember which snarl each inward-facing boundary reads into
+            boundary_index.emplace(make_pair(snarl.start().node_id(), snarl.start().backward()), i);
+            boundary_index.emplace(make_pair(snarl.end().node_id(), !snarl.end().backward()), i);
+        }
         
+        for (size_t i = 0; i < snarls.size(); i++) {
+            Snarl& snarl = snarls[i];
+            
             // is this a top-level snarl?
             if (snarl.has_parent()) {
-                // add this snarl to the parent-to-children index
-                if (!children.count(key_form(&(snarl.parent()))) ) {
-                    children.insert(make_pair(key_form(&snarl.parent()), vector<const Snarl*>(1, &snarl)));
-                }
-                else {
-                    children[key_form(&(snarl.parent()))].push_back(&snarl);
+                auto found = index_of.find(key_form(&snarl.parent()));
+                if (found != index_of.end()) {
+                    // record the relationship in both directions
+                    children[found->second].push_back(&snarl);
+                    parent[i] = &snarls[found->second];
                 }
             }
             else {
                 // record top level status
                 roots.push_back(&snarl);
-                parent[key_form(&snarl)] = nullptr;
-            }
-        }
-        
-        for (Snarl& snarl : snarls) {
-            if (children.count(key_form(&snarl))) {
-                // mark this snarl as the parent in child-to-parent map
-                for (const Snarl* child : children[key_form(&snarl)]) {
-                    parent[key_form(child)] = &snarl;
-                }
-            }
-            else {
-                // ensure that all snarls are in the parent-to-children map
-                children.insert(make_pair(key_form(&snarl), vector<const Snarl*>()));
             }
         }
     }
@@ -10,6 +10,7 @@
 
 #include <cstdint>
 #include <stdio.h>
+#include <limits>
 #include <unordered_map>
 #include <unordered_set>
 #include "vg.hpp"
@@ -32,6 +33,10 @@ namespace vg {
         template <typename SnarlIterator>
         SnarlManager(SnarlIterator begin, SnarlIterator end);
         
+        /// Construct a SnarlManager from a serialized snarl tree index (a
+        /// stream of Snarls, as written by serialize() or "vg snarls")
+        SnarlManager(istream& in);
+        
         /// Default constructor
         SnarlManager() = default;
         
@@ -86,28 +91,72 @@ namespace vg {
         /// pointer to the managed copy of that Snarl.
         const Snarl* manage(const Snarl& not_owned);
         
+        /// Returns the Snarl that a traversal of the given node in the given
+        /// orientation reads into (i.e. the Snarl with that start Visit or with
+        /// the reverse of that end Visit), or nullptr if there is none.
+        const Snarl* into_which_snarl(id_t id, bool backward);
+        
+        /// Returns the Snarl that a Visit reads into, or nullptr if it reads
+        /// into none.
+        const Snarl* into_which_snarl(const Visit& visit);
+        
+        /// Record which Snarl most tightly contains each node of the graph, so
+        /// that innermost_snarl_containing() can be answered in constant time.
+        /// Must be called again if the graph or the snarls change.
+        void index_node_contents(VG& graph);
+        
+        /// Returns the innermost Snarl whose interior contains the given node
+        /// (boundary nodes belong to the parent of the Snarl they bound), or
+        /// nullptr if the node is in no Snarl. Requires index_node_contents().
+        const Snarl* innermost_snarl_containing(id_t node_id);
+        
+        /// Returns the number of Snarls managed
+        size_t num_snarls() const;
+        
+        /// Write the snarl tree index to a stream of Snarls, parents before
+        /// children, so it can be stored alongside the graph's other indexes
+        /// and loaded with SnarlManager(istream&).
+        void serialize(ostream& out);
+        
     private:
     
         /// Define the key type
         using key_t = pair<pair<int64_t, bool>, pair<int64_t, bool>>;
         
+        /// Sentinel for "no snarl" in the flat index arrays
+        static const size_t no_snarl = numeric_limits<size_t>::max();
+        
         /// Master list of the snarls in the graph
         vector<Snarl> snarls;
         
         /// Roots of snarl trees
         vector<const Snarl*> roots;
         
-        /// Map of snarls to the child snarls they contain
-        unordered_map<key_t, vector<const Snarl*>> children;
-        unordered_map<key_t, const Snarl*> parent;
+        /// Children of each snarl, indexed by the snarl's number in the master
+        /// list
+        vector<vector<const Snarl*>> children;
+        /// Parent of each snarl, indexed by the snarl's number in the master
+        /// list (nullptr for roots)
+        vector<const Snarl*> parent;
         
         /// Map of snarl keys to the indexes in the snarl array
-        // TODO: should we switch to just pointers here and save an indirection?
         unordered_map<key_t, size_t> index_of;
         
+        /// Map of inward-facing boundary traversals (the start Visit or the
+        /// reversed end Visit) to the number of the snarl they read into
+        unordered_map<pair<id_t, bool>, size_t> boundary_index;
+        
+        /// Map of node IDs to the number of the innermost snarl containing
+        /// them, filled in by index_node_contents()
+        unordered_map<id_t, size_t> node_index;
+        
         /// Converts Snarl to the form used as keys in internal data structures
         inline key_t key_form(const Snarl* snarl);
         
+        /// Get the number of a snarl in the master list. Pointers we own are
+        /// resolved by their offset; other Snarls are looked up by key.
+        inline size_t number_of(const Snarl* snarl);
+        
         /// Builds tree indices after Snarls have been added
         void build_indexes();
     };
@@ -194,14 +194,40 @@ int main_add(int argc, char** argv) {
             adder.add_name_mapping(rename.first, rename.second);
         }
 
-        #pragma omp parallel for
-        for (size_t i = 0; i < vcfs.size(); i++) {
-            // For each VCF
-            auto& vcf = *vcfs[i];
-            
-            // Add the variants from the VCF to the graph, at the same
-            // time as other VCFs.
-            adder.add_variants(&vcf);        
+        // If all the VCFs are tabix-indexed, we can do one VCF at a time
+        // with all our threads on different contigs.
+        bool all_tabix = true;
+        for (auto& vcf : vcfs) {
+            all_tabix = all_tabix && vcf->usingTabix;
+        }
+        
+        if (all_tabix && get_thread_count() > 1) {
+            for (size_t i = 0; i < vcfs.size(); i++) {
+                // Open another reader on this VCF for each thread
+                vector<unique_ptr<vcflib::VariantCallFile>> readers;
+                vector<vcflib::VariantCallFile*> reader_pointers{vcfs[i].get()};
+                for (int j = 1; j < get_thread_count(); j++) {
+                    readers.emplace_back(new vcflib::VariantCallFile());
+                    readers.back()->open(vcf_filenames[i]);
+                    if (!readers.back()->is_open()) {
+                        cerr << "error:[vg add] could not open " << vcf_filenames[i] << endl;
+                        return 1;
+                    }
+                    reader_pointers.push_back(readers.back().get());
+                }
+                
+                adder.add_variants(reader_pointers);
+            }
+        } else {
+            #pragma omp parallel for
+            for (size_t i = 0; i < vcfs.size(); i++) {
+                // For each VCF
+                auto& vcf = *vcfs[i];
+                
+                // Add the variants from the VCF to the graph, at the same
+                // time as other VCFs.
+                adder.add_variants(&vcf);        
+            }
         }
         
         // TODO: should we sort the graph?
@@ -30,7 +30,8 @@ void help_chunk(char** argv) {
          << "options:" << endl
          << "    -x, --xg-name FILE       use this xg index to chunk subgraphs" << endl
          << "    -a, --gam-index FILE     chunk this gam index (made with vg index -N) instead of the graph" << endl
-         << "    -g, --gam-and-graph      when used in combination with -a, both gam and graph will be chunked" << endl 
+         << "    -G, --gam-stream FILE    chunk this gam (ideally sorted by node id) in a single pass, without an index" << endl
+         << "    -g, --gam-and-graph      when used in combination with -a or -G, both gam and graph will be chunked" << endl 
          << "path chunking:" << endl
          << "    -p, --path TARGET        write the chunk in the specified (1-based inclusive)\n"
          << "                             path range TARGET=path[:pos1[-pos2]]" << endl
@@ -60,6 +61,7 @@ int main_chunk(int argc, char** argv) {
 
     string xg_file;
     string gam_file;
+    string gam_stream_file;
     bool gam_and_graph = false;
     string region_string;
     string path_list_file;
@@ -80,6 +82,7 @@ int main_chunk(int argc, char** argv) {
             {"help", no_argument, 0, 'h'},
             {"xg-name", required_argument, 0, 'x'},
             {"gam-name", required_argument, 0, 'a'},
+            {"gam-stream", required_argument, 0, 'G'},
             {"gam-and-graph", no_argument, 0, 'g'},
             {"path", required_argument, 0, 'p'},
             {"path-names", required_argument, 0, 'P'},
@@ -95,7 +98,7 @@ int main_chunk(int argc, char** argv) {
         };
 
         int option_index = 0;
-        c = getopt_long (argc, argv, "hx:a:gp:P:s:o:r:R:b:c:it:",
+        c = getopt_long (argc, argv, "hx:a:G:gp:P:s:o:r:R:b:c:it:",
                 long_options, &option_index);
 
 
@@ -114,6 +117,10 @@ int main_chunk(int argc, char** argv) {
             gam_file = optarg;
             break;
             
+        case 'G':
+            gam_stream_file = optarg;
+            break;
+            
         case 'g':
             gam_and_graph = true;
             break;            
@@ -181,12 +188,17 @@ int main_chunk(int argc, char** argv) {
         cerr << "error:[vg chunk] at most one of {-p, -P, -r} required to specify input regions" << endl;
         return 1;
     }
+    if (!gam_file.empty() && !gam_stream_file.empty()) {
+        cerr << "error:[vg chunk] at most one of {-a, -G} can be used to specify input alignments" << endl;
+        return 1;
+    }
 
     // figure out which outputs we want.  the graph always
     // needs to be chunked, even if only gam output is requested,
     // because we use the graph to get the nodes we're looking for.
     // but we only write the subgraphs to disk if chunk_graph is true. 
-    bool chunk_gam = !gam_file.empty();
+    bool chunk_gam = !gam_file.empty() || !gam_stream_file.empty();
+    bool stream_gam = !gam_stream_file.empty();
     bool chunk_graph = gam_and_graph || !chunk_gam;
 
     // Load our index
@@ -201,7 +213,7 @@ int main_chunk(int argc, char** argv) {
 
     // This holds the RocksDB index that has all our reads, indexed by the nodes they visit.
     Index gam_index;
-    if (chunk_gam) {
+    if (chunk_gam && !stream_gam) {
         gam_index.open_read_only(gam_file);
     }
 
@@ -296,6 +308,10 @@ int main_chunk(int argc, char** argv) {
     // we return this in a bed file. 
     vector<Region> output_regions(regions.size());
 
+    // when streaming the gam, we remember the nodes of every chunk, and
+    // pull out all the alignments at the end in one pass
+    vector<vector<vg::id_t>> chunk_ids(stream_gam ? regions.size() : 0);
+
     // initialize chunkers
     vector<PathChunker> chunkers(threads);
     for (auto& chunker : chunkers) {
@@ -345,7 +361,18 @@ int main_chunk(int argc, char** argv) {
         }
         
         // optional gam chunking
-        if (chunk_gam) {
+        if (stream_gam) {
+            if (subgraph != NULL) {
+                subgraph->for_each_node([&](Node* node) {
+                    chunk_ids[i].push_back(node->id());
+                });
+            } else {
+                assert(id_range == true);
+                for (vg::id_t id = region.start; id <= region.end; ++id) {
+                    chunk_ids[i].push_back(id);
+                }
+            }
+        } else if (chunk_gam) {
             string gam_name = chunk_name(i, output_regions[i], true);
             ofstream out_gam_file(gam_name);
             if (!out_gam_file) {
@@ -362,6 +389,19 @@ int main_chunk(int argc, char** argv) {
 
         delete subgraph;
     }
+
+    if (stream_gam) {
+        vector<string> gam_names;
+        for (int i = 0; i < regions.size(); ++i) {
+            gam_names.push_back(chunk_name(i, output_regions[i], true));
+        }
+        ifstream gam_stream(gam_stream_file);
+        if (!gam_stream) {
+            cerr << "error[vg chunk]: unable to open gam file " << gam_stream_file << endl;
+            return 1;
+        }
+        chunkers[0].extract_gam_for_chunks(gam_stream, chunk_ids, gam_names);
+    }
         
     // write a bed file if asked giving a more explicit linking of chunks to files
     if (!out_bed_file.empty()) {
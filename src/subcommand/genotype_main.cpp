@@ -32,6 +32,7 @@ void help_genotype(char** argv) {
          << "    -a, --augmented FILE    dump augmented graph to FILE" << std::endl
          << "    -q, --use_mapq          use mapping qualities" << std::endl
          << "    -C, --cactus            use cactus ultrabubbles for site finding" << std::endl
+         << "    -L, --snarls FILE       load sites from snarls of the augmented graph in FILE instead of finding them" << std::endl
          << "    -S, --subset-graph      only use the reference and areas of the graph with read support" << std::endl
          << "    -i, --realign_indels    realign at indels" << std::endl
          << "    -d, --het_prior_denom   denominator for prior probability of heterozygousness" << std::endl
@@ -73,6 +74,9 @@ int main_genotype(int argc, char** argv) {
     string fasta;
     string insertions_file;
 
+    // Should we load the augmented graph's snarls instead of finding sites?
+    string snarls_file_name;
+
     // Should we use mapping qualities?
     bool use_mapq = false;
     // Should we do indel realignment?
@@ -105,6 +109,7 @@ int main_genotype(int argc, char** argv) {
                 {"augmented", required_argument, 0, 'a'},
                 {"use_mapq", no_argument, 0, 'q'},
                 {"cactus", no_argument, 0, 'C'},
+                {"snarls", required_argument, 0, 'L'},
                 {"subset-graph", no_argument, 0, 'S'},
                 {"realign_indels", no_argument, 0, 'i'},
                 {"het_prior_denom", required_argument, 0, 'd'},
@@ -119,7 +124,7 @@ int main_genotype(int argc, char** argv) {
             };
 
         int option_index = 0;
-        c = getopt_long (argc, argv, "hjvr:c:s:o:l:a:qCSid:P:pt:V:I:G:F:",
+        c = getopt_long (argc, argv, "hjvr:c:s:o:l:a:qCL:Sid:P:pt:V:I:G:F:",
                          long_options, &option_index);
 
         /* Detect the end of the options. */
@@ -166,6 +171,10 @@ int main_genotype(int argc, char** argv) {
             // Use Cactus to find sites
             use_cactus = true;
             break;
+        case 'L':
+            // Load sites from a snarls file
+            snarls_file_name = optarg;
+            break;
         case 'S':
             // Find sites on the graph subset with any read support
             subset_graph = true;
@@ -215,6 +224,11 @@ int main_genotype(int argc, char** argv) {
         omp_set_num_threads(thread_count);
     }
 
+    if (!snarls_file_name.empty() && subset_graph) {
+        cerr << "error:[vg genotype] snarls can't be loaded (-L) when finding sites on a subset graph (-S)" << endl;
+        return 1;
+    }
+
     // read the graph
     if (optind >= argc) {
         help_genotype(argv);
@@ -301,6 +315,7 @@ int main_genotype(int argc, char** argv) {
     assert(het_prior_denominator > 0);
     genotyper.het_prior_logprob = prob_to_logprob(1.0/het_prior_denominator);
     genotyper.min_consistent_per_strand = min_consistent_per_strand;
+    genotyper.snarls_file_name = snarls_file_name;
     // TODO: move arguments below up into configuration
     genotyper.run(*graph,
                   alignments,
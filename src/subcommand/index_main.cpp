@@ -16,6 +16,9 @@
 #include "../vg_set.hpp"
 #include "../utility.hpp"
 #include "../path_index.hpp"
+#include "../kmer_range_table.hpp"
+#include "../distance_index.hpp"
+#include "../genotypekit.hpp"
 
 #include "gcsa/gcsa.h"
 #include "gcsa/algorithms.h"
@@ -36,6 +39,8 @@ void help_index(char** argv) {
          << "    -r, --rename V=P       rename contig V in the VCFs to path P in the graph (may repeat)" << endl
          << "    -T, --store-threads    use gPBWT to store the embedded paths as threads" << endl
          << "    -H, --write-haps FILE  write the paths generated from the VCF file in binary to FILE (don't write gPBWT)" << endl
+         << "    -c, --dist-index       also save an index of distances over the graph's snarls beside the" << endl
+         << "                           xg index (<xg>" << DistanceIndex::EXTENSION << "), which vg map uses in place of graph searches" << endl
          << "gcsa options:" << endl
          << "    -g, --gcsa-out FILE    output a GCSA2 index instead of a rocksdb index" << endl
          << "    -i, --dbg-in FILE      optionally use deBruijn graph encoded in FILE rather than an input VG (multiple allowed" << endl
@@ -52,6 +57,8 @@ void help_index(char** argv) {
          << "    -t, --threads N        number of threads to use" << endl
          << "    -p, --progress         show progress" << endl
          << "    -V, --verify-index     validate the GCSA2 index using the input kmers (important for testing)" << endl
+         << "    -K, --kmer-ranges N    also save the GCSA2 ranges of all N-mers beside the index, so vg map" << endl
+         << "                           can start MEM searches from them (N <= " << KmerRangeTable::MAX_K << ", 4^N entries)" << endl
          << "rocksdb options (ignored with -g):" << endl
          << "    -d, --db-name  <X>     store the database in <X>" << endl
          << "    -s, --store-graph      store graph as xg" << endl
@@ -121,6 +128,8 @@ int main_index(int argc, char** argv) {
     bool dump_alignments = false;
     int doubling_steps = 3;
     bool verify_index = false;
+    int kmer_ranges_size = 0;
+    bool build_distance_index = false;
     bool forward_only = false;
     size_t size_limit = 200; // in gigabytes
     bool store_threads = false; // use gPBWT to store paths
@@ -164,11 +173,13 @@ int main_index(int argc, char** argv) {
             {"dbg-in", required_argument, 0, 'i'},
             {"discard-overlaps", no_argument, 0, 'o'},
             {"write-haps", required_argument, 0, 'H'},
+            {"kmer-ranges", required_argument, 0, 'K'},
+            {"dist-index", no_argument, 0, 'c'},
             {0, 0, 0, 0}
         };
 
         int option_index = 0;
-        c = getopt_long (argc, argv, "d:k:j:pDshMt:b:e:SP:LmaCnAg:X:x:v:r:VFZ:Oi:TNoH:",
+        c = getopt_long (argc, argv, "d:k:j:pDshMt:b:e:SP:LmaCnAg:X:x:v:r:VFZ:Oi:TNoH:K:c",
                 long_options, &option_index);
 
         // Detect the end of the options.
@@ -298,6 +309,19 @@ int main_index(int argc, char** argv) {
             doubling_steps = atoi(optarg);
             break;
 
+        case 'K':
+            kmer_ranges_size = atoi(optarg);
+            if (kmer_ranges_size < 1 || kmer_ranges_size > KmerRangeTable::MAX_K) {
+                cerr << "error:[vg index] k-mer range table size must be between 1 and "
+                     << KmerRangeTable::MAX_K << endl;
+                return 1;
+            }
+            break;
+
+        case 'c':
+            build_distance_index = true;
+            break;
+
         case 'Z':
             size_limit = atoi(optarg);
             break;
@@ -873,6 +897,25 @@ int main_index(int argc, char** argv) {
         ofstream db_out(xg_name);
         index.serialize(db_out);
         db_out.close();
+
+        if (build_distance_index) {
+            // the snarls have to be found in one graph holding everything
+            VG joined;
+            graphs.for_each([&](VG* graph) {
+                joined.extend(*graph);
+            });
+            if (show_progress) {
+                cerr << "Finding snarls for distance index..." << endl;
+            }
+            CactusUltrabubbleFinder snarl_finder(joined);
+            SnarlManager snarl_manager = snarl_finder.find_snarls();
+            if (show_progress) {
+                cerr << "Indexing distances over " << snarl_manager.num_snarls() << " snarls..." << endl;
+            }
+            DistanceIndex distance_index(joined, snarl_manager);
+            ofstream distance_out(xg_name + DistanceIndex::EXTENSION);
+            distance_index.serialize(distance_out);
+        }
     }
 
     if (!gcsa_name.empty()) {
@@ -923,10 +966,20 @@ int main_index(int argc, char** argv) {
 
         // Save the GCSA2 index
         sdsl::store_to_file(*gcsa_index, gcsa_name);
-        delete gcsa_index;
 
         // Save the LCP array
         sdsl::store_to_file(*lcp_array, lcp_name);
+
+        if (kmer_ranges_size) {
+            // Tabulate where backward searches for short k-mers end up
+            if (show_progress) {
+                cerr << "Building table of " << kmer_ranges_size << "-mer ranges" << endl;
+            }
+            KmerRangeTable kmer_ranges(*gcsa_index, *lcp_array, kmer_ranges_size);
+            ofstream kmer_ranges_out(gcsa_name + KmerRangeTable::EXTENSION);
+            kmer_ranges.serialize(kmer_ranges_out);
+        }
+        delete gcsa_index;
         delete lcp_array;
 
     }
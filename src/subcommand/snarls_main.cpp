@@ -25,6 +25,7 @@ void help_snarl(char** argv) {
          << "options:" << endl
          << "    -b, --superbubbles    describe (in text) the superbubbles of the graph" << endl
          << "    -u, --ultrabubbles    describe (in text) the ultrabubbles of the graph" << endl
+         << "    -L, --snarls FILE     load snarls previously found for the graph from FILE instead of finding them" << endl
          << "traversals:" << endl
          << "    -p, --pathnames       output variant paths as SnarlTraversals to STDOUT" << endl
          << "    -r, --traversals FILE output SnarlTraversals for ultrabubbles." << endl
@@ -55,6 +56,7 @@ int main_snarl(int argc, char** argv) {
     bool filter_trivial_bubbles = false;
     bool sort_snarls = false;
     bool fill_path_names = false;
+    string snarls_file;
 
     int c;
     optind = 2; // force optind past command positional argument
@@ -71,11 +73,12 @@ int main_snarl(int argc, char** argv) {
                 {"max-nodes", required_argument, 0, 'm'},
                 {"filter-trivial", no_argument, 0, 't'},
                 {"sort-snarls", no_argument, 0, 's'},
+                {"snarls", required_argument, 0, 'L'},
                 {0, 0, 0, 0}
             };
 
         int option_index = 0;
-        c = getopt_long (argc, argv, "bsur:ltopim:h?",
+        c = getopt_long (argc, argv, "bsur:ltopim:L:h?",
                          long_options, &option_index);
 
         /* Detect the end of the options. */
@@ -124,6 +127,10 @@ int main_snarl(int argc, char** argv) {
             fill_path_names = true;
             break;
             
+        case 'L':
+            snarls_file = optarg;
+            break;
+            
         case 'h':
         case '?':
             /* getopt_long already printed an error message. */
@@ -184,11 +191,21 @@ int main_snarl(int argc, char** argv) {
         return 0;
     }
     
-    // The only implemented snarl finder:
-    SnarlFinder* snarl_finder = new CactusUltrabubbleFinder(*graph, "", filter_trivial_bubbles);
-    
-    // Load up all the snarls
-    SnarlManager snarl_manager = snarl_finder->find_snarls();
+    // Load up all the snarls, either from a file or with the only
+    // implemented snarl finder
+    SnarlManager snarl_manager = [&]() -> SnarlManager {
+        if (snarls_file.empty()) {
+            CactusUltrabubbleFinder snarl_finder(*graph, "", filter_trivial_bubbles);
+            return snarl_finder.find_snarls();
+        }
+        ifstream snarls_stream(snarls_file);
+        if (!snarls_stream) {
+            cerr << "error:[vg snarl]: Could not open \"" << snarls_file
+                 << "\" for reading" << endl;
+            exit(1);
+        }
+        return SnarlManager(snarls_stream);
+    }();
     vector<const Snarl*> snarl_roots = snarl_manager.top_level_snarls();
     if (fill_path_names){
         //delete trav_finder;
@@ -302,7 +319,6 @@ int main_snarl(int argc, char** argv) {
         stream::write_buffered(trav_stream, traversal_buffer, 0);
     }
     
-    delete snarl_finder;
     delete trav_finder;
     delete graph;
 
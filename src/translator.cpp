@@ -25,34 +25,58 @@ void Translator::load(const vector<Translation>& trans) {
 }
 
 void Translator::build_position_table(void) {
-    //map<pos_t, Translation*> pos_to_trans;
+    pos_to_trans.clear();
+    pos_to_trans.reserve(translations.size());
     for (auto& t : translations) {
         // map from the new positions to the corresponding translations
-        pos_to_trans[make_pos_t(t.to().mapping(0).position())] = &t;
+        pos_to_trans.emplace_back(make_pos_t(t.to().mapping(0).position()), &t);
     }
+    // keep the last translation given for any duplicated position, like a map
+    // assignment would
+    stable_sort(pos_to_trans.begin(), pos_to_trans.end(),
+                [](const pair<pos_t, const Translation*>& a, const pair<pos_t, const Translation*>& b) {
+                    return a.first < b.first;
+                });
+    vector<pair<pos_t, const Translation*>> deduplicated;
+    deduplicated.reserve(pos_to_trans.size());
+    for (size_t i = 0; i < pos_to_trans.size(); ++i) {
+        if (i + 1 < pos_to_trans.size() && pos_to_trans[i + 1].first == pos_to_trans[i].first) {
+            continue;
+        }
+        deduplicated.push_back(pos_to_trans[i]);
+    }
+    swap(pos_to_trans, deduplicated);
 }
 
-Translation Translator::get_translation(const Position& position) {
+const Translation& Translator::get_translation(const Position& position) const {
+    static const Translation empty;
     auto pos = make_pos_t(position);
+    auto pos_less = [](const pair<pos_t, const Translation*>& entry, const pos_t& p) {
+        return entry.first < p;
+    };
     // check that the node is in the translation
     pos_t node_only = pos;
     get_offset(node_only) = 0;
     get_is_rev(node_only) = position.is_reverse();
-    Translation translation;
-    if (pos_to_trans.find(node_only) == pos_to_trans.end()) {
+    auto node_start = lower_bound(pos_to_trans.begin(), pos_to_trans.end(), node_only, pos_less);
+    if (node_start == pos_to_trans.end() || node_start->first != node_only) {
         cerr << "WARNING: node " << id(pos) << " is not in the translation table" << endl;
-    } else {
-        auto t = pos_to_trans.upper_bound(pos); --t;
-        translation = *t->second;
+        return empty;
     }
-    return translation;
+    // find the last translation starting at or before the position
+    auto t = upper_bound(node_start, pos_to_trans.end(), pos,
+                         [](const pos_t& p, const pair<pos_t, const Translation*>& entry) {
+                             return p < entry.first;
+                         });
+    --t;
+    return *t->second;
 }
 
-Position Translator::translate(const Position& position) {
+Position Translator::translate(const Position& position) const {
     return translate(position, get_translation(position));
 }
 
-Position Translator::translate(const Position& position, const Translation& translation) {
+Position Translator::translate(const Position& position, const Translation& translation) const {
     // what kind of translation is it?
     if (is_match(translation)) {
         if (position.offset() >= mapping_from_length(translation.to().mapping(0))) {
@@ -70,10 +94,10 @@ Position Translator::translate(const Position& position, const Translation& tran
     }
 }
 
-Mapping Translator::translate(const Mapping& mapping) {
+Mapping Translator::translate(const Mapping& mapping) const {
     Mapping translated = mapping;
     if (!mapping.has_position()) return mapping;
-    Translation translation = get_translation(mapping.position());
+    const Translation& translation = get_translation(mapping.position());
     *translated.mutable_position() = translate(mapping.position(), translation);
     if (is_match(translation)) {
         return translated;
@@ -113,7 +137,7 @@ Mapping Translator::translate(const Mapping& mapping) {
     return translated;
 }
 
-Path Translator::translate(const Path& path) {
+Path Translator::translate(const Path& path) const {
     Path result;
     for (int i = 0; i < path.mapping_size(); ++i) {
         *result.add_mapping() = translate(path.mapping(i));
@@ -121,13 +145,19 @@ Path Translator::translate(const Path& path) {
     return simplify(result);
 }
 
-Alignment Translator::translate(const Alignment& aln) {
-    Alignment result = aln;
-    *result.mutable_path() = translate(aln.path());
+Alignment Translator::translate(const Alignment& aln) const {
+    Alignment result;
+    translate(aln, result);
     return result;
 }
 
-Locus Translator::translate(const Locus& locus) {
+void Translator::translate(const Alignment& aln, Alignment& result) const {
+    // CopyFrom reuses the memory result already has
+    result.CopyFrom(aln);
+    *result.mutable_path() = translate(aln.path());
+}
+
+Locus Translator::translate(const Locus& locus) const {
     Locus result = locus;
     for (int i = 0; i < locus.allele_size(); ++i) {
         *result.mutable_allele(i) = translate(locus.allele(i));
@@ -144,7 +174,7 @@ bool is_match(const Translation& translation) {
         && path_to_length(translation.from()) == path_to_length(translation.to());
 }
 
-Translation Translator::overlay(const Translation& trans) {
+Translation Translator::overlay(const Translation& trans) const {
     Translation result;
     *result.mutable_to() = trans.to();
     *result.mutable_from() = translate(trans.from());
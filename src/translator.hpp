@@ -27,20 +27,29 @@ class Translator {
 public:
 
     vector<Translation> translations;
-    map<pos_t, Translation*> pos_to_trans;
+    /// Start position of the to-path of each translation, and the
+    /// translation, sorted by position so we can binary search it.
+    vector<pair<pos_t, const Translation*>> pos_to_trans;
     Translator(void);
     Translator(istream& in);
     Translator(const vector<Translation>& trans);
     void load(const vector<Translation>& trans);
     void build_position_table(void);
-    Translation get_translation(const Position& position);
-    Position translate(const Position& position);
-    Position translate(const Position& position, const Translation& translation);    
-    Mapping translate(const Mapping& mapping);
-    Path translate(const Path& path);
-    Alignment translate(const Alignment& aln);
-    Locus translate(const Locus& locus);
-    Translation overlay(const Translation& trans);
+    /// Get the translation covering the given position. The reference is valid
+    /// as long as the Translator is not reloaded. If the position's node is
+    /// not translated, warns and returns an empty Translation.
+    const Translation& get_translation(const Position& position) const;
+    /// All the translate methods are safe to call from multiple threads once
+    /// the Translator is loaded.
+    Position translate(const Position& position) const;
+    Position translate(const Position& position, const Translation& translation) const;
+    Mapping translate(const Mapping& mapping) const;
+    Path translate(const Path& path) const;
+    Alignment translate(const Alignment& aln) const;
+    Locus translate(const Locus& locus) const;
+    /// Translate into an existing Alignment, so its storage can be reused.
+    void translate(const Alignment& aln, Alignment& result) const;
+    Translation overlay(const Translation& trans) const;
 };
 
 bool is_match(const Translation& translation);
@@ -0,0 +1,150 @@
+//
+//  distance_index.cpp
+//
+//  Unit tests for DistanceIndex
+//
+
+#include <stdio.h>
+#include <iostream>
+#include <sstream>
+#include "catch.hpp"
+#include "distance_index.hpp"
+#include "genotypekit.hpp"
+#include "position.hpp"
+#include "xg.hpp"
+
+namespace vg {
+    namespace unittest {
+
+        // Look up a distance, requiring that the index can answer
+        static int64_t indexed_distance(const DistanceIndex& index, pos_t pos1, pos_t pos2) {
+            int64_t distance;
+            REQUIRE(index.min_distance(pos1, pos2, distance));
+            return distance;
+        }
+
+        TEST_CASE( "DistanceIndex finds minimum distances", "[snarls][distance]" ) {
+
+            SECTION( "DistanceIndex measures through a simple bubble" ) {
+
+                VG graph;
+
+                Node* n1 = graph.create_node("GCA");
+                Node* n2 = graph.create_node("T");
+                Node* n3 = graph.create_node("GG");
+                Node* n4 = graph.create_node("CTGA");
+
+                graph.create_edge(n1, n2);
+                graph.create_edge(n1, n3);
+                graph.create_edge(n2, n4);
+                graph.create_edge(n3, n4);
+
+                CactusUltrabubbleFinder bubble_finder(graph, "");
+                SnarlManager snarl_manager = bubble_finder.find_snarls();
+                DistanceIndex index(graph, snarl_manager);
+
+                // the shorter allele is the way to go
+                REQUIRE(indexed_distance(index, make_pos_t(n1->id(), false, 0), make_pos_t(n4->id(), false, 0)) == 4);
+                REQUIRE(indexed_distance(index, make_pos_t(n1->id(), false, 1), make_pos_t(n3->id(), false, 1)) == 3);
+                REQUIRE(indexed_distance(index, make_pos_t(n4->id(), false, 0), make_pos_t(n4->id(), false, 2)) == 2);
+                // the reverse strand works the same way
+                REQUIRE(indexed_distance(index, make_pos_t(n4->id(), true, 0), make_pos_t(n1->id(), true, 0)) == 5);
+                // you can't get from one allele to the other, or go backward
+                REQUIRE(indexed_distance(index, make_pos_t(n2->id(), false, 0), make_pos_t(n3->id(), false, 0)) == -1);
+                REQUIRE(indexed_distance(index, make_pos_t(n4->id(), false, 0), make_pos_t(n1->id(), false, 0)) == -1);
+            }
+
+            SECTION( "DistanceIndex measures through nested snarls" ) {
+
+                VG graph;
+
+                Node* n1 = graph.create_node("GCA");
+                Node* n2 = graph.create_node("T");
+                Node* n3 = graph.create_node("G");
+                Node* n4 = graph.create_node("CTGA");
+                Node* n5 = graph.create_node("GCA");
+                Node* n6 = graph.create_node("T");
+                Node* n7 = graph.create_node("G");
+                Node* n8 = graph.create_node("CTGA");
+
+                graph.create_edge(n1, n2);
+                graph.create_edge(n1, n8);
+                graph.create_edge(n2, n3);
+                graph.create_edge(n2, n6);
+                graph.create_edge(n3, n4);
+                graph.create_edge(n3, n5);
+                graph.create_edge(n4, n5);
+                graph.create_edge(n5, n7);
+                graph.create_edge(n6, n7);
+                graph.create_edge(n7, n8);
+
+                CactusUltrabubbleFinder bubble_finder(graph, "");
+                SnarlManager snarl_manager = bubble_finder.find_snarls();
+                DistanceIndex index(graph, snarl_manager);
+
+                REQUIRE(indexed_distance(index, make_pos_t(n1->id(), false, 0), make_pos_t(n8->id(), false, 0)) == 3);
+                REQUIRE(indexed_distance(index, make_pos_t(n2->id(), false, 0), make_pos_t(n7->id(), false, 0)) == 2);
+                REQUIRE(indexed_distance(index, make_pos_t(n3->id(), false, 0), make_pos_t(n5->id(), false, 0)) == 1);
+                // out of the innermost snarl and all the way to the end
+                REQUIRE(indexed_distance(index, make_pos_t(n4->id(), false, 0), make_pos_t(n8->id(), false, 0)) == 8);
+                // from the top level into the innermost snarl
+                REQUIRE(indexed_distance(index, make_pos_t(n1->id(), false, 0), make_pos_t(n4->id(), false, 1)) == 6);
+                REQUIRE(indexed_distance(index, make_pos_t(n6->id(), false, 0), make_pos_t(n4->id(), false, 0)) == -1);
+
+                SECTION( "DistanceIndex can be saved and loaded" ) {
+
+                    stringstream serialized;
+                    index.serialize(serialized);
+                    DistanceIndex loaded;
+                    loaded.load(serialized);
+
+                    REQUIRE(indexed_distance(loaded, make_pos_t(n4->id(), false, 0), make_pos_t(n8->id(), false, 0)) == 8);
+                    REQUIRE(indexed_distance(loaded, make_pos_t(n1->id(), false, 0), make_pos_t(n4->id(), false, 1)) == 6);
+                }
+
+                SECTION( "DistanceIndex agrees with the distances the mapper measures in the xg index" ) {
+
+                    xg::XG xg_index(graph.graph);
+                    LRUCache<id_t, Node> node_cache(100);
+                    LRUCache<id_t, vector<Edge> > edge_cache(100);
+                    int maximum = 100;
+
+                    // every position on either strand of every node
+                    vector<pos_t> positions;
+                    graph.for_each_node([&](Node* node) {
+                        for (size_t i = 0; i < node->sequence().size(); i++) {
+                            positions.push_back(make_pos_t(node->id(), false, i));
+                            positions.push_back(make_pos_t(node->id(), true, i));
+                        }
+                    });
+
+                    // try a spread of pairs, the way Mapper::graph_distance
+                    // would turn the answers into capped distances
+                    size_t compared = 0;
+                    for (size_t i = 0; i < positions.size(); i += 3) {
+                        for (size_t j = 0; j < positions.size(); j += 2) {
+                            int64_t distance;
+                            if (!index.min_distance(positions[i], positions[j], distance)) {
+                                continue;
+                            }
+                            int capped = distance < 0 || distance > maximum ? maximum : distance;
+                            REQUIRE(capped == xg_cached_distance(positions[i], positions[j], maximum,
+                                                                 &xg_index, node_cache, edge_cache));
+                            compared++;
+                        }
+                    }
+                    REQUIRE(compared > 0);
+                }
+
+                SECTION( "DistanceIndex can tell which graph it was built from" ) {
+
+                    REQUIRE(index.matches(xg::XG(graph.graph)));
+
+                    // the same nodes joined differently are another graph
+                    graph.create_edge(n2, n5);
+                    REQUIRE(!index.matches(xg::XG(graph.graph)));
+                }
+            }
+        }
+    }
+}
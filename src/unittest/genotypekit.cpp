@@ -361,6 +361,66 @@ TEST_CASE("ExhaustiveTraversalFinder finds all paths on a bubble with an inverte
     REQUIRE(found_trav_2);
 }
 
+TEST_CASE("ExhaustiveTraversalFinder visits child snarls", "[genotype]") {
+    VG graph;
+    Node* n1 = graph.create_node("A");
+    Node* n2 = graph.create_node("C");
+    Node* n3 = graph.create_node("G");
+    Node* n4 = graph.create_node("T");
+    Node* n5 = graph.create_node("A");
+    Node* n6 = graph.create_node("C");
+    graph.create_edge(n1, n2);
+    graph.create_edge(n1, n6);
+    graph.create_edge(n2, n3);
+    graph.create_edge(n2, n4);
+    graph.create_edge(n3, n5);
+    graph.create_edge(n4, n5);
+    graph.create_edge(n5, n6);
+    
+    Snarl site;
+    site.mutable_start()->set_node_id(n1->id());
+    site.mutable_end()->set_node_id(n6->id());
+    site.set_type(ULTRABUBBLE);
+    
+    Snarl child;
+    child.mutable_start()->set_node_id(n2->id());
+    child.mutable_end()->set_node_id(n5->id());
+    child.set_type(ULTRABUBBLE);
+    *child.mutable_parent() = site;
+    
+    list<Snarl> snarls{site, child};
+    
+    SnarlManager manager(snarls.begin(), snarls.end());
+    
+    ExhaustiveTraversalFinder finder(graph, manager);
+    
+    const Snarl* top = manager.top_level_snarls().at(0);
+    auto travs = finder.find_traversals(*top);
+    
+    // One traversal skips the child, and the other goes through it as a unit
+    REQUIRE(travs.size() == 2);
+    
+    bool found_empty = false;
+    bool found_child = false;
+    for (auto& trav : travs) {
+        if (trav.visits_size() == 0) {
+            found_empty = true;
+        }
+        else if (trav.visits_size() == 1 && trav.visits(0).node_id() == 0) {
+            REQUIRE(trav.visits(0).snarl().start().node_id() == n2->id());
+            REQUIRE(trav.visits(0).snarl().end().node_id() == n5->id());
+            REQUIRE(!trav.visits(0).backward());
+            found_child = true;
+        }
+    }
+    REQUIRE(found_empty);
+    REQUIRE(found_child);
+    
+    // The child's own traversals go through its two alleles
+    auto child_travs = finder.find_traversals(*manager.children_of(top).at(0));
+    REQUIRE(child_travs.size() == 2);
+}
+
 TEST_CASE("SiteFinder can differntiate ultrabubbles from snarls", "[genotype]") {
 
     SECTION("Directed cycle does not count as ultrabubble") {
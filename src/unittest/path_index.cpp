@@ -112,6 +112,20 @@ TEST_CASE("PathIndex translation can change a node ID", "[pathindex]") {
         REQUIRE(index.at_position(6).node == 99);
     }
     
+    SECTION("Translations of nodes off the path leave the index alone") {
+        // Node 3 is not on the path
+        Translation off_path = t;
+        off_path.mutable_from()->mutable_mapping(0)->mutable_position()->set_node_id(3);
+        REQUIRE(!index.apply_translations(vector<Translation>{off_path}));
+        
+        // But node 99 is, now
+        Translation on_path = t;
+        on_path.mutable_from()->mutable_mapping(0)->mutable_position()->set_node_id(99);
+        on_path.mutable_to()->mutable_mapping(0)->mutable_position()->set_node_id(100);
+        REQUIRE(index.apply_translations(vector<Translation>{on_path}));
+        REQUIRE(index.at_position(6).node == 100);
+    }
+    
 }
 
 TEST_CASE("PathIndex translation can divide a node", "[pathindex]") {
@@ -171,6 +185,34 @@ TEST_CASE("PathIndex translation can divide a node", "[pathindex]") {
         REQUIRE(index.node_length(index.find_position(4)) == 2);
     }
     
+    SECTION("After translation, rounding sees the divided node without compaction") {
+        REQUIRE(index.round_outward(3, 4) == make_pair((size_t) 3, (size_t) 5));
+        REQUIRE(index.round_outward(2, 3) == make_pair((size_t) 2, (size_t) 3));
+        // Untouched nodes come straight from the flat tables
+        REQUIRE(index.round_outward(0, 1) == make_pair((size_t) 0, (size_t) 1));
+    }
+    
+    SECTION("After translation and compaction, lookups still see the new nodes") {
+        // Collect the answers from the map
+        auto rounded = index.round_outward(3, 4);
+        
+        index.compact();
+        
+        REQUIRE(index.at_position(2).node == 1337);
+        REQUIRE(index.at_position(3).node == 1338);
+        REQUIRE(index.at_position(4).node == 1338);
+        REQUIRE(index.round_outward(3, 4) == rounded);
+        REQUIRE(rounded == make_pair((size_t) 3, (size_t) 5));
+        
+        // The occurrence tables see the divided node too
+        size_t found = index.next_occurrence(3);
+        REQUIRE(found < index.occurrence_count());
+        REQUIRE(index.occurrence_start(found) == 3);
+        REQUIRE(index.occurrence_side(found).node == 1338);
+        REQUIRE(index.occurrence_length(found) == 2);
+        REQUIRE(index.occurrence_start(index.next_occurrence(4)) == 5);
+    }
+    
 }
 
 TEST_CASE("PathIndex translation can create reverse strand mappings", "[pathindex]") {
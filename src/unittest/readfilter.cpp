@@ -4,6 +4,9 @@
 
 #include "catch.hpp"
 #include "readfilter.hpp"
+#include "stream.hpp"
+
+#include <sstream>
 
 namespace vg {
 namespace unittest {
@@ -270,6 +273,46 @@ TEST_CASE("reads with ambiguous ends can be trimmed", "[filter]") {
 
 }
 
+TEST_CASE("reads dropped by one criterion stay dropped in verbose mode", "[filter]") {
+    
+    // Two otherwise identical unmapped reads, one with a poor mapping quality
+    vector<Alignment> reads(2);
+    reads[0].set_name("poor");
+    reads[0].set_sequence("GATTACA");
+    reads[0].set_mapping_quality(10);
+    reads[1].set_name("good");
+    reads[1].set_sequence("GATTACA");
+    reads[1].set_mapping_quality(60);
+    
+    stringstream gam_in;
+    stream::write_buffered(gam_in, reads, 0);
+    
+    ReadFilter filter;
+    filter.min_mapq = 30;
+    filter.verbose = true;
+    
+    // Capture the reads written to standard output, and the report verbose
+    // mode writes to standard error
+    stringstream gam_out;
+    stringstream report;
+    auto old_cout = cout.rdbuf(gam_out.rdbuf());
+    auto old_cerr = cerr.rdbuf(report.rdbuf());
+    int status = filter.filter(&gam_in);
+    cout.rdbuf(old_cout);
+    cerr.rdbuf(old_cerr);
+    
+    REQUIRE(status == 0);
+    
+    // Counting every criterion mustn't let the region check keep the read
+    vector<string> kept;
+    function<void(Alignment&)> lambda = [&](Alignment& aln) {
+        kept.push_back(aln.name());
+    };
+    stream::for_each(gam_out, lambda);
+    REQUIRE(kept.size() == 1);
+    REQUIRE(kept[0] == "good");
+}
+
 
 }
 }
@@ -0,0 +1,150 @@
+/**
+ * \file
+ * unittest/realigner.cpp: test cases for the Realigner, which realigns poor
+ * alignments against indexes that it can cache on disk.
+ */
+
+#include "catch.hpp"
+#include "../realigner.hpp"
+
+#include "../json2pb.h"
+#include "../vg.pb.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace vg {
+namespace unittest {
+using namespace std;
+
+// A SNP between two stretches of unique sequence
+const string realigner_graph = R"(
+    {
+        "node": [
+            {"id": 1, "sequence": "CAAATAAGGCTTGGAAATTTTCTGGAGTTCTATTATATTCCAACTCTCTG"},
+            {"id": 2, "sequence": "G"},
+            {"id": 3, "sequence": "T"},
+            {"id": 4, "sequence": "TTCCTGAATTGATTGCTTAGGACATTTAAGTCATATTTATGCGTTCATCGAA"}
+        ],
+        "edge": [
+            {"from": 1, "to": 2},
+            {"from": 1, "to": 3},
+            {"from": 2, "to": 4},
+            {"from": 3, "to": 4}
+        ],
+        "path": [
+            {"name": "x", "mapping": [
+                {"position": {"node_id": 1}, "rank": 1},
+                {"position": {"node_id": 2}, "rank": 2},
+                {"position": {"node_id": 4}, "rank": 3}
+            ]}
+        ]
+    }
+)";
+
+// A read taking the alternate allele, with one sequencing error
+const string realigner_read = "GGAGTTCTATTATATTCCAACTCTCTGTTTCCTGAATTGATTGCTTAGGAGATTTAAG";
+
+/// Make sure two alignments put the read in the same place the same way.
+static void require_same_alignment(const Alignment& a, const Alignment& b) {
+    REQUIRE(a.score() == b.score());
+    REQUIRE(pb2json(a.path()) == pb2json(b.path()));
+}
+
+TEST_CASE("Realigner realigns reads the way a Mapper would", "[realigner]") {
+
+    Graph proto;
+    json2pb(proto, realigner_graph.c_str(), realigner_graph.size());
+    VG graph;
+    graph.extend(proto);
+
+    // Build the indexes ourselves
+    xg::XG xg_index(graph.graph);
+    gcsa::GCSA* gcsa_index = nullptr;
+    gcsa::LCPArray* lcp_index = nullptr;
+    graph.build_gcsa_lcp(gcsa_index, lcp_index, 16, false, false, 3);
+
+    Mapper mapper(&xg_index, gcsa_index, lcp_index);
+
+    Alignment unaligned;
+    unaligned.set_sequence(realigner_read);
+    Alignment expected = mapper.align_multi(unaligned).front();
+
+    SECTION("An unaligned read needs realignment") {
+        Realigner realigner;
+        REQUIRE(realigner.needs_realignment(unaligned));
+        REQUIRE(!realigner.needs_realignment(expected));
+    }
+
+    SECTION("Realigning against loaded indexes matches the Mapper") {
+        Realigner realigner;
+        realigner.load(&xg_index, gcsa_index, lcp_index);
+
+        require_same_alignment(realigner.realign(unaligned), expected);
+
+        // A batch gets the same answer, and leaves good alignments alone
+        vector<Alignment> batch {unaligned, expected};
+        realigner.realign(batch);
+        require_same_alignment(batch[0], expected);
+        require_same_alignment(batch[1], expected);
+    }
+
+    SECTION("Constructed indexes round-trip through the cache") {
+        char dir_template[] = "vg-realigner-test-XXXXXX";
+        REQUIRE(mkdtemp(dir_template) != nullptr);
+        string cache_dir(dir_template);
+
+        Realigner building;
+        building.construct(graph, cache_dir);
+        require_same_alignment(building.realign(unaligned), expected);
+
+        // All the indexes got moved into place
+        string prefix = building.cache_prefix(cache_dir, graph.hash());
+        vector<string> cached {prefix + ".xg", prefix + gcsa::GCSA::EXTENSION,
+            prefix + gcsa::GCSA::EXTENSION + ".lcp"};
+        for (auto& filename : cached) {
+            REQUIRE(ifstream(filename).good());
+            REQUIRE(!ifstream(filename + ".tmp" + to_string(getpid())).good());
+        }
+
+        // Swap in indexes of just the first node under the cached names, so
+        // we can tell if they get loaded
+        VG marker;
+        marker.create_node("CAAATAAGGCTTGGAAATTTTCTGGAGTTCTATTATATTCCAACTCTCTG");
+        xg::XG marker_xg(marker.graph);
+        gcsa::GCSA* marker_gcsa = nullptr;
+        gcsa::LCPArray* marker_lcp = nullptr;
+        marker.build_gcsa_lcp(marker_gcsa, marker_lcp, 16, false, false, 3);
+        {
+            ofstream xg_out(cached[0]);
+            marker_xg.serialize(xg_out);
+        }
+        REQUIRE(sdsl::store_to_file(*marker_gcsa, cached[1]));
+        REQUIRE(sdsl::store_to_file(*marker_lcp, cached[2]));
+        
+        Mapper marker_mapper(&marker_xg, marker_gcsa, marker_lcp);
+        Alignment marker_expected = marker_mapper.align_multi(unaligned).front();
+        REQUIRE(marker_expected.score() < expected.score());
+        
+        // And another Realigner loads them instead of building
+        Realigner loading;
+        loading.construct(graph, cache_dir);
+        require_same_alignment(loading.realign(unaligned), marker_expected);
+        
+        delete marker_gcsa;
+        delete marker_lcp;
+
+        for (auto& filename : cached) {
+            remove(filename.c_str());
+        }
+        rmdir(cache_dir.c_str());
+    }
+
+    delete gcsa_index;
+    delete lcp_index;
+}
+
+}
+}
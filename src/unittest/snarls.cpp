@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include <iostream>
+#include <sstream>
 #include <set>
 #include "json2pb.h"
 #include "vg.pb.h"
@@ -472,6 +473,95 @@ namespace vg {
             
             
             
+            SECTION( "SnarlManager can be serialized and answers boundary and containment queries") {
+                
+                VG graph;
+                
+                Node* n1 = graph.create_node("GCA");
+                Node* n2 = graph.create_node("T");
+                Node* n3 = graph.create_node("G");
+                Node* n4 = graph.create_node("CTGA");
+                Node* n5 = graph.create_node("A");
+                Node* n6 = graph.create_node("C");
+                Node* n7 = graph.create_node("GT");
+                
+                graph.create_edge(n1, n2);
+                graph.create_edge(n1, n7);
+                graph.create_edge(n2, n3);
+                graph.create_edge(n2, n4);
+                graph.create_edge(n3, n5);
+                graph.create_edge(n4, n5);
+                graph.create_edge(n5, n6);
+                graph.create_edge(n6, n7);
+                
+                Snarl snarl1;
+                snarl1.mutable_start()->set_node_id(n1->id());
+                snarl1.mutable_end()->set_node_id(n7->id());
+                snarl1.set_type(ULTRABUBBLE);
+                
+                Snarl snarl2;
+                snarl2.mutable_start()->set_node_id(n2->id());
+                snarl2.mutable_end()->set_node_id(n5->id());
+                snarl2.set_type(ULTRABUBBLE);
+                *snarl2.mutable_parent() = snarl1;
+                
+                list<Snarl> snarls;
+                snarls.push_back(snarl2);
+                snarls.push_back(snarl1);
+                
+                SnarlManager original(snarls.begin(), snarls.end());
+                
+                stringstream serialized;
+                original.serialize(serialized);
+                
+                SnarlManager snarl_manager(serialized);
+                
+                REQUIRE(snarl_manager.num_snarls() == 2);
+                REQUIRE(snarl_manager.top_level_snarls().size() == 1);
+                
+                const Snarl* top_snarl = snarl_manager.top_level_snarls()[0];
+                REQUIRE(*top_snarl == snarl1);
+                REQUIRE(snarl_manager.children_of(top_snarl).size() == 1);
+                
+                const Snarl* child_snarl = snarl_manager.children_of(top_snarl)[0];
+                REQUIRE(*child_snarl == snarl2);
+                REQUIRE(snarl_manager.parent_of(child_snarl) == top_snarl);
+                REQUIRE(snarl_manager.is_leaf(child_snarl));
+                REQUIRE(snarl_manager.is_root(top_snarl));
+                
+                SECTION( "Boundary traversals find the snarls they read into" ) {
+                    REQUIRE(snarl_manager.into_which_snarl(n1->id(), false) == top_snarl);
+                    REQUIRE(snarl_manager.into_which_snarl(n7->id(), true) == top_snarl);
+                    REQUIRE(snarl_manager.into_which_snarl(n2->id(), false) == child_snarl);
+                    REQUIRE(snarl_manager.into_which_snarl(n5->id(), true) == child_snarl);
+                    REQUIRE(snarl_manager.into_which_snarl(n1->id(), true) == nullptr);
+                    REQUIRE(snarl_manager.into_which_snarl(n5->id(), false) == nullptr);
+                    REQUIRE(snarl_manager.into_which_snarl(to_visit(n2->id(), false)) == child_snarl);
+                    
+                    Visit managed_visit;
+                    *managed_visit.mutable_snarl() = snarl2;
+                    REQUIRE(snarl_manager.into_which_snarl(managed_visit) == child_snarl);
+                    
+                    // A visit to a snarl we don't manage reads into nothing
+                    Visit unmanaged_visit;
+                    unmanaged_visit.mutable_snarl()->mutable_start()->set_node_id(n3->id());
+                    unmanaged_visit.mutable_snarl()->mutable_end()->set_node_id(n4->id());
+                    REQUIRE(snarl_manager.into_which_snarl(unmanaged_visit) == nullptr);
+                }
+                
+                SECTION( "Nodes are assigned to the innermost snarl containing them" ) {
+                    snarl_manager.index_node_contents(graph);
+                    
+                    REQUIRE(snarl_manager.innermost_snarl_containing(n1->id()) == nullptr);
+                    REQUIRE(snarl_manager.innermost_snarl_containing(n2->id()) == top_snarl);
+                    REQUIRE(snarl_manager.innermost_snarl_containing(n3->id()) == child_snarl);
+                    REQUIRE(snarl_manager.innermost_snarl_containing(n4->id()) == child_snarl);
+                    REQUIRE(snarl_manager.innermost_snarl_containing(n5->id()) == top_snarl);
+                    REQUIRE(snarl_manager.innermost_snarl_containing(n6->id()) == top_snarl);
+                    REQUIRE(snarl_manager.innermost_snarl_containing(n7->id()) == nullptr);
+                }
+            }
+            
             SECTION( "SnarlManager can correctly extract the full contents of a reversing-edge snarl") {
                 
                 string graph_json = R"(
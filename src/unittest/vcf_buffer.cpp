@@ -136,5 +136,70 @@ ref	18	rs1342	A	G	29	PASS	.	GT
     
 }
 
+TEST_CASE( "WindowedVcfBuffer parses genotypes in sample order", "[windowedvcfbuffer][vcf]" ) {
+
+    // Sample names are deliberately not in sorted order
+    auto vcf_data = R"(##fileformat=VCFv4.0
+##FORMAT=<ID=GT,Number=1,Type=String,Description="Genotype">
+#CHROM	POS	ID	REF	ALT	QUAL	FILTER	INFO	FORMAT	zed	alpha	mid
+ref	5	rs1337	A	G,T	29	PASS	.	GT	0|1	1/1	.|2
+ref	7	rs1338	A	G	29	PASS	.	GT	1|0	0|0	0|1
+ref	8	rs1339	A	G	29	PASS	.	GT	0|0	0|1	1|1
+)";
+
+    std::stringstream vcf_stream(vcf_data);
+    vcflib::VariantCallFile vcf;
+    vcf.open(vcf_stream);
+    
+    WindowedVcfBuffer buffer(&vcf, 10);
+    REQUIRE(buffer.next());
+    
+    vector<vcflib::Variant*> before;
+    vector<vcflib::Variant*> after;
+    vcflib::Variant* current;
+    tie(before, current, after) = buffer.get();
+    REQUIRE(after.size() == 2);
+    
+    // Parse the whole window at once
+    vector<vcflib::Variant*> window{current, after[0], after[1]};
+    buffer.cache_parsed_genotypes(window);
+    
+    SECTION("genotypes come out in VCF sample order") {
+        auto& genotypes = buffer.get_parsed_genotypes(current);
+        REQUIRE(genotypes.size() == 3);
+        REQUIRE(genotypes[0] == vector<int>({0, 1}));
+        REQUIRE(genotypes[1] == vector<int>({1, 1}));
+        REQUIRE(genotypes[2] == vector<int>({vcflib::NULL_ALLELE, 2}));
+    }
+    
+    SECTION("batch parsing agrees with parsing one at a time") {
+        // Read the same VCF again, and parse each variant on its own as we
+        // come to it
+        std::stringstream single_stream(vcf_data);
+        vcflib::VariantCallFile single_vcf;
+        single_vcf.open(single_stream);
+        WindowedVcfBuffer single_buffer(&single_vcf, 10);
+        
+        for (auto* batch_variant : window) {
+            REQUIRE(single_buffer.next());
+            vector<vcflib::Variant*> single_before;
+            vector<vcflib::Variant*> single_after;
+            vcflib::Variant* single_variant;
+            tie(single_before, single_variant, single_after) = single_buffer.get();
+            REQUIRE(single_variant->id == batch_variant->id);
+            
+            REQUIRE(single_buffer.get_parsed_genotypes(single_variant) ==
+                buffer.get_parsed_genotypes(batch_variant));
+        }
+        REQUIRE(!single_buffer.next());
+        
+        auto& genotypes = buffer.get_parsed_genotypes(window[2]);
+        REQUIRE(genotypes.size() == 3);
+        REQUIRE(genotypes[0] == vector<int>({0, 0}));
+        REQUIRE(genotypes[1] == vector<int>({0, 1}));
+        REQUIRE(genotypes[2] == vector<int>({1, 1}));
+    }
+}
+
 }
 }
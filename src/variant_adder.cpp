@@ -25,6 +25,71 @@ void VariantAdder::add_variants(vcflib::VariantCallFile* vcf) {
     // Make a buffer
     WindowedVcfBuffer buffer(vcf, variant_range);
     
+    // Do all the variants, with a progress bar per contig
+    add_buffered_variants(buffer, true);
+
+    // Clean up after the last contig.
+    destroy_progress();
+    
+}
+
+void VariantAdder::add_variants(const vector<vcflib::VariantCallFile*>& vcfs) {
+    
+    assert(!vcfs.empty());
+    for (auto* vcf : vcfs) {
+        if (!vcf->usingTabix) {
+            throw runtime_error("Parallel variant adding requires a tabix-indexed VCF");
+        }
+    }
+    
+    // We only look up the contigs the graph has paths for, so a VCF contig
+    // with no path would otherwise be skipped silently. Check for them the way
+    // add_buffered_variants() does, from the contigs in the tabix indexes.
+    set<string> checked_contigs;
+    for (auto* vcf : vcfs) {
+        for (auto& vcf_contig : vcf->tabixFile->chroms) {
+            auto path_name = vcf_to_fasta(vcf_contig);
+            if (path_names.count(path_name) || checked_contigs.count(path_name)) {
+                continue;
+            }
+            checked_contigs.insert(path_name);
+            if (ignore_missing_contigs) {
+                cerr << "warning:[vg::VariantAdder] skipping missing contig " << path_name << endl;
+            } else {
+                throw runtime_error("Contig " + path_name + " mentioned in VCF but not found in graph");
+            }
+        }
+    }
+    
+    // Variants on different paths never touch the same graph region, so we
+    // can hand each thread its own path. Do the paths in a fixed order.
+    vector<string> contigs(path_names.begin(), path_names.end());
+    
+    create_progress("contigs", contigs.size());
+    
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < contigs.size(); i++) {
+        // Each thread has its own reader
+        int tid = omp_get_thread_num();
+        assert(tid < vcfs.size());
+        
+        WindowedVcfBuffer buffer(vcfs[tid], variant_range);
+        if (buffer.set_region(fasta_to_vcf(contigs[i]))) {
+            // The VCF has this contig, so do its variants. Per-contig progress
+            // bars would fight each other.
+            add_buffered_variants(buffer, false);
+        }
+        
+        #pragma omp critical (progress)
+        increment_progress();
+    }
+    
+    destroy_progress();
+    
+}
+
+void VariantAdder::add_buffered_variants(WindowedVcfBuffer& buffer, bool contig_progress) {
+    
     // Count how many variants we have done
     size_t variants_processed = 0;
     
@@ -80,13 +145,15 @@ void VariantAdder::add_variants(vcflib::VariantCallFile* vcf) {
     
         // Interlude: do the progress bar
         // TODO: not really thread safe
-        if (variant_path_name != prev_path_name) {
-            // Moved to a new contig
-            prev_path_name = variant_path_name;
-            destroy_progress();
-            create_progress("contig " + variant_path_name, path_sequence.size());
+        if (contig_progress) {
+            if (variant_path_name != prev_path_name) {
+                // Moved to a new contig
+                prev_path_name = variant_path_name;
+                destroy_progress();
+                create_progress("contig " + variant_path_name, path_sequence.size());
+            }
+            update_progress(variant_path_offset);
         }
-        update_progress(variant_path_offset);
         
         // Figure out what the actual bounds of this variant are. For big
         // deletions, the variant itself may be bigger than the window we're
@@ -377,9 +444,6 @@ void VariantAdder::add_variants(vcflib::VariantCallFile* vcf) {
         }
         
     }
-
-    // Clean up after the last contig.
-    destroy_progress();
     
 }
 
@@ -769,6 +833,17 @@ set<vector<int>> VariantAdder::get_unique_haplotypes(const vector<vcflib::Varian
         return haplotypes;
     }
     
+    // If we have a cache, parse all the variants' genotypes up front (in
+    // parallel) and hold on to the parsed tables, so we don't have to look
+    // each variant up again for every sample.
+    vector<const vector<vector<int>>*> parsed_genotypes;
+    if (cache != nullptr) {
+        cache->cache_parsed_genotypes(variants);
+        for (auto* variant : variants) {
+            parsed_genotypes.push_back(&cache->get_parsed_genotypes(variant));
+        }
+    }
+    
     for (size_t sample_index = 0; sample_index < variants.front()->sampleNames.size(); sample_index++) {
         // For every sample
         auto& sample_name = variants.front()->sampleNames[sample_index];
@@ -779,13 +854,15 @@ set<vector<int>> VariantAdder::get_unique_haplotypes(const vector<vcflib::Varian
         map<size_t, vector<int>> sample_haplotypes;
         
         
-        for (auto* variant : variants) {
+        for (size_t variant_index = 0; variant_index < variants.size(); variant_index++) {
+            auto* variant = variants[variant_index];
+            
             // Get the genotype for each sample
             const vector<int>* genotype;
             
             if (cache != nullptr) {
-                // Use the cache provided by the buffer
-                genotype = &cache->get_parsed_genotypes(variant).at(sample_index);
+                // Use the genotypes the buffer parsed for us
+                genotype = &parsed_genotypes[variant_index]->at(sample_index);
             } else {
                 // Parse from the variant ourselves
                 auto genotype_string = variant->getGenotype(sample_name);
@@ -40,6 +40,13 @@ public:
      */
     void add_variants(vcflib::VariantCallFile* vcf);
     
+    /**
+     * Add in the variants from a tabix-indexed VCF, working on different
+     * graph paths in parallel. Takes one freshly opened reader on the VCF for
+     * each thread. Only visits VCF contigs that correspond to graph paths.
+     */
+    void add_variants(const vector<vcflib::VariantCallFile*>& vcfs);
+    
     /**
      * Align the given string to the given graph, wetween the given endpoints,
      * using the most appropriate alignment method, depending on the relative
@@ -127,6 +134,13 @@ public:
     bool print_updates = false;
     
 protected:
+    
+    /**
+     * Add all the variants that the given buffer produces. If contig_progress
+     * is set, show a progress bar for each contig in turn.
+     */
+    void add_buffered_variants(WindowedVcfBuffer& buffer, bool contig_progress);
+    
     /// The graph we are modifying
     VG& graph;
     
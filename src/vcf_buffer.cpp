@@ -91,6 +91,9 @@ bool WindowedVcfBuffer::set_region(const string& contig, int64_t start, int64_t
     variants_before.clear();
     variants_after.clear();
     current.reset(nullptr);
+    // The variants we had parsed genotypes for are all gone now, and their
+    // addresses may be reused.
+    cached_genotypes.clear();
     
     return reader.set_region(contig, start, end);
 }
@@ -217,62 +220,102 @@ tuple<vector<vcflib::Variant*>, vcflib::Variant*, vector<vcflib::Variant*>> Wind
 
 const vector<vector<int>>& WindowedVcfBuffer::get_parsed_genotypes(vcflib::Variant* variant) {
 
-    if (!cached_genotypes.count(variant)) {
-        // We need to parse the genotypes for this variant
-        
-        if (map_order_to_original.empty()) {
-            // First we need to build our table converting from sample index in
-            // map iteration order to sample index in the original order.
-            
-            
-            // But to do that we need to be able to look up original index by
-            // sample name.
-            map<string, size_t> original_index_by_name;
-            for (size_t i = 0; i < variant->sampleNames.size(); i++) {
-                // Basically invert the vector's mapping
-                original_index_by_name[variant->sampleNames[i]] = i;
-            }
-            
-            for (auto& kv : variant->samples) {
-                // Now we go through the samples (where all the format field
-                // data is kept) in map iteration order, and put the actual
-                // sample number for each.
-                map_order_to_original.push_back(original_index_by_name.at(kv.first));
-            }
-            
-            // We're going to have to account for all the samples in the file.
-            assert(map_order_to_original.size() == variant->sampleNames.size());
-        }
+    auto found = cached_genotypes.find(variant);
+    if (found != cached_genotypes.end()) {
+        return found->second;
+    }
+    
+    // We need to parse the genotypes for this variant
+    index_sample_order(variant);
+    
+    // Make a vector to fill in, with one entry per sample
+    auto result = cached_genotypes.emplace(piecewise_construct,
+        forward_as_tuple(variant), 
+        forward_as_tuple(variant->sampleNames.size()));
+    assert(result.second);
+    decode_genotypes(variant, result.first->second);
+    
+    return result.first->second;
+}
 
-        // Make a vector to fill in, with one entry per sample
+void WindowedVcfBuffer::cache_parsed_genotypes(const vector<vcflib::Variant*>& variants) {
+    
+    // Make slots for all the variants we haven't parsed yet. The map can only
+    // be modified from one thread, but once the slots exist each one can be
+    // filled in independently.
+    vector<pair<vcflib::Variant*, vector<vector<int>>*>> to_parse;
+    for (auto* variant : variants) {
+        if (cached_genotypes.count(variant)) {
+            continue;
+        }
+        
+        index_sample_order(variant);
+        
         auto result = cached_genotypes.emplace(piecewise_construct,
             forward_as_tuple(variant), 
             forward_as_tuple(variant->sampleNames.size()));
         assert(result.second);
-        auto& genotypes = result.first->second;
-        
-        // Track what entry we're on in the map from sample to FORMAT values
-        size_t map_index = 0;
-        for (auto& kv : variant->samples) {
-            // Go through all the parsed FORMAT fields for each sample
-            
-            // Figure out where in the vector by original sample index our
-            // result goes.
-            size_t original_index = map_order_to_original.at(map_index);
-            
-            // Pull out the GT value. Explode if there isn't one (though
-            // something like "." is acceptable)
-            auto& gt_string = kv.second.at("GT").at(0);
-            
-            // Decompose it and fill in the genotype slot for this sample.
-            genotypes[original_index] = decompose_genotype_fast(gt_string);
-            
-            // Next we'll look at the next sample in map order.
-            map_index++;
-        }
+        to_parse.emplace_back(variant, &result.first->second);
+    }
+    
+    // With thousands of samples, splitting out the GT strings is where all
+    // the time goes, so do the variants in parallel.
+#pragma omp parallel for schedule(dynamic, 1) if (to_parse.size() > 1)
+    for (size_t i = 0; i < to_parse.size(); i++) {
+        decode_genotypes(to_parse[i].first, *to_parse[i].second);
     }
-    return cached_genotypes.at(variant);
+}
 
+void WindowedVcfBuffer::index_sample_order(vcflib::Variant* variant) {
+    if (!map_order_to_original.empty()) {
+        // Already done
+        return;
+    }
+
+    // We need to build our table converting from sample index in map
+    // iteration order to sample index in the original order.
+    
+    // But to do that we need to be able to look up original index by
+    // sample name.
+    map<string, size_t> original_index_by_name;
+    for (size_t i = 0; i < variant->sampleNames.size(); i++) {
+        // Basically invert the vector's mapping
+        original_index_by_name[variant->sampleNames[i]] = i;
+    }
+    
+    for (auto& kv : variant->samples) {
+        // Now we go through the samples (where all the format field
+        // data is kept) in map iteration order, and put the actual
+        // sample number for each.
+        map_order_to_original.push_back(original_index_by_name.at(kv.first));
+    }
+    
+    // We're going to have to account for all the samples in the file.
+    assert(map_order_to_original.size() == variant->sampleNames.size());
+}
+
+void WindowedVcfBuffer::decode_genotypes(vcflib::Variant* variant, vector<vector<int>>& genotypes) const {
+    assert(genotypes.size() == variant->sampleNames.size());
+    
+    // Track what entry we're on in the map from sample to FORMAT values
+    size_t map_index = 0;
+    for (auto& kv : variant->samples) {
+        // Go through all the parsed FORMAT fields for each sample
+        
+        // Figure out where in the vector by original sample index our
+        // result goes.
+        size_t original_index = map_order_to_original.at(map_index);
+        
+        // Pull out the GT value. Explode if there isn't one (though
+        // something like "." is acceptable)
+        auto& gt_string = kv.second.at("GT").at(0);
+        
+        // Decompose it and fill in the genotype slot for this sample.
+        genotypes[original_index] = decompose_genotype_fast(gt_string);
+        
+        // Next we'll look at the next sample in map order.
+        map_index++;
+    }
 }
 
 vector<int> WindowedVcfBuffer::decompose_genotype_fast(const string& genotype) {
@@ -157,6 +157,14 @@ public:
      */
     const vector<vector<int>>& get_parsed_genotypes(vcflib::Variant* variant);
     
+    /**
+     * Make sure parsed genotypes are cached for all of the given variants,
+     * which must be owned by this WindowedVcfBuffer. Variants that have not
+     * been parsed yet are decoded in parallel, so callers that are about to
+     * look at the genotypes of a whole window should call this first.
+     */
+    void cache_parsed_genotypes(const vector<vcflib::Variant*>& variants);
+    
     /**
      * This returns true if we have a tabix index, and false otherwise. If this
      * is false, set_region may be called, but will do nothing and return false.
@@ -188,6 +196,19 @@ protected:
      */
     static vector<int> decompose_genotype_fast(const string& genotype);
     
+    /**
+     * Fill in map_order_to_original from the samples of the given variant, if
+     * it has not been filled in already.
+     */
+    void index_sample_order(vcflib::Variant* variant);
+    
+    /**
+     * Decode the GT field of every sample of the given variant into the given
+     * vector, which must already have one entry per sample. Safe to call from
+     * multiple threads at once for different variants.
+     */
+    void decode_genotypes(vcflib::Variant* variant, vector<vector<int>>& genotypes) const;
+    
     // This lets us read from our VCF
     VcfBuffer reader;
     
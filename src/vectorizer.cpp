@@ -214,6 +214,102 @@ bit_vector Vectorizer::alignment_to_onehot(Alignment a){
     return ret;
 }
 
+Vectorizer::sparse_vector Vectorizer::alignment_to_sparse(const Alignment& a, bool a_hot, bool identity_hot) const {
+    sparse_vector ret;
+    const Path& path = a.path();
+    for (int i = 0; i < path.mapping_size(); i++){
+        const Mapping& mapping = path.mapping(i);
+        if (!mapping.has_position()){
+            continue;
+        }
+        int64_t node_id = mapping.position().node_id();
+
+        // Same edge lookup as the dense vectors
+        if (i > 0){
+            int64_t prev_node_id = path.mapping(i - 1).position().node_id();
+            if (my_xg->has_edge(prev_node_id, false, node_id, false)){
+                int64_t edge_key = my_xg->edge_rank_as_entity(prev_node_id, false, node_id, false);
+                double value = 1.0;
+                if (a_hot && my_xg->paths_of_entity(edge_key).empty()){
+                    value = 2.0;
+                }
+                ret.emplace_back(edge_key - 1, value);
+            }
+        }
+
+        double value = 1.0;
+        if (a_hot){
+            value = my_xg->paths_of_node(node_id).empty() ? 1.0 : 2.0;
+        }
+        else if (identity_hot){
+            double match_len = 0.0;
+            double total_len = 0.0;
+            for (int j = 0; j < mapping.edit_size(); j++){
+                const Edit& e = mapping.edit(j);
+                total_len += e.from_length();
+                if (e.from_length() == e.to_length() && e.sequence().empty()){
+                    match_len += (double) e.to_length();
+                }
+            }
+            value = (match_len == 0.0 && total_len == 0.0) ? 0.0 : (match_len / total_len);
+        }
+        ret.emplace_back(my_xg->node_rank_as_entity(node_id) - 1, value);
+    }
+
+    // When an entity is visited more than once the last visit wins, as it
+    // would in the dense vectors.
+    stable_sort(ret.begin(), ret.end(), [](const pair<size_t, double>& x, const pair<size_t, double>& y){
+        return x.first < y.first;
+    });
+    size_t kept = 0;
+    for (size_t i = 0; i < ret.size(); i++){
+        if (i + 1 < ret.size() && ret[i + 1].first == ret[i].first){
+            continue;
+        }
+        if (ret[i].second != 0.0){
+            ret[kept++] = ret[i];
+        }
+    }
+    ret.resize(kept);
+
+    return ret;
+}
+
+string Vectorizer::format_sparse(const sparse_vector& v) const {
+    stringstream sout;
+    for (int i = 0; i < v.size(); i++){
+        sout << v[i].first << ":" << v[i].second;
+        if (i < v.size() - 1){
+            sout << " ";
+        }
+    }
+    return sout.str();
+}
+
+void Vectorizer::write_sparse(ostream& out, const string& name, const sparse_vector& v) const {
+    uint32_t name_length = name.size();
+    out.write((const char*) &name_length, sizeof(name_length));
+    out.write(name.data(), name_length);
+    uint32_t entries = v.size();
+    out.write((const char*) &entries, sizeof(entries));
+    for (auto& entry : v){
+        uint64_t index = entry.first;
+        double value = entry.second;
+        out.write((const char*) &index, sizeof(index));
+        out.write((const char*) &value, sizeof(value));
+    }
+}
+
+string Vectorizer::wabbitize_sparse(string name, const sparse_vector& v){
+    stringstream sout;
+    if (!(wabbit_map.count(name) > 0)){
+        wabbit_map[name] = wabbit_map.size();
+    }
+    sout << wabbit_map[name] << " " << "1.0" << " " << "'" << name
+        << " " << "|" << " " << "vectorspace" << " " << format_sparse(v);
+    return sout.str();
+}
+
 vector<double> Vectorizer::alignment_to_custom_score(Alignment a, std::function<double(Alignment)> lambda ){
     vector<double> ret;
     
@@ -31,6 +31,24 @@ class Vectorizer{
     vector<int> alignment_to_a_hot(Alignment a);
     vector<double> alignment_to_custom_score(Alignment a, std::function<double(Alignment)> lambda);
     vector<double> alignment_to_identity_hot(Alignment a);
+
+    /// A sparse feature vector: (entity index, value) pairs sorted by index,
+    /// with zero entries left out. Indexes are the 0-based columns of the
+    /// dense vectors above, so they cover both nodes and edges.
+    typedef vector<pair<size_t, double>> sparse_vector;
+    /// Get the sparse equivalent of alignment_to_onehot, or of
+    /// alignment_to_a_hot or alignment_to_identity_hot if a_hot or
+    /// identity_hot is set, without allocating anything graph-sized. Safe to
+    /// call from multiple threads.
+    sparse_vector alignment_to_sparse(const Alignment& a, bool a_hot = false, bool identity_hot = false) const;
+    /// Format a sparse vector as space-separated index:value pairs.
+    string format_sparse(const sparse_vector& v) const;
+    /// Write a sparse vector as a binary COO record: a uint32 name length,
+    /// the name, a uint32 entry count, and then that many uint64 index and
+    /// double value pairs, all in native byte order.
+    void write_sparse(ostream& out, const string& name, const sparse_vector& v) const;
+    /// Like wabbitize, but only emit the nonzero entries.
+    string wabbitize_sparse(string name, const sparse_vector& v);
     string output_wabbit_map();
     template<typename T> string format(T v){
         stringstream sout;
@@ -5,7 +5,7 @@ BASH_TAP_ROOT=../deps/bash-tap
 
 PATH=../bin:$PATH # for vg
 
-plan tests 32
+plan tests 40
 
 vg construct -r small/x.fa -v small/x.vcf.gz >x.vg
 vg index -x x.xg -g x.gcsa -k 11 x.vg
@@ -34,6 +34,11 @@ is $(vg map -s $seq -x x.xg -g x.gcsa | vg view -a - | jq -c '[.score, .sequence
 
 is $(vg map -b small/x.bam -x x.xg -g x.gcsa -j | jq .quality | grep null | wc -l) 0 "alignment from BAM correctly handles qualities"
 
+# enough unmapped reads to fill more batches than the BAM reader keeps in flight
+(printf "@HD\tVN:1.5\n"; seq 1 140000 | awk '{ printf "r%d\t4\t*\t0\t0\t*\t*\t0\t0\tGATTACA\tIIIIIII\n", $1 }') | samtools view -b - >many.bam
+is $(vg map -t 1 -b many.bam -x x.xg -g x.gcsa | vg view -a - | wc -l) 140000 "a single thread reads a BAM file of many batches"
+rm -f many.bam
+
 is $(vg map -s $seq -w 30 -x x.xg -g x.gcsa | vg surject -x x.xg -s - | wc -l) 4 "banded alignment produces a correct alignment"
 
 scores=$(vg map -s GCACCAGGACCCAGAGAGTTGGAATGCCAGGCATTTCCTCTGTTTTCTTTCACCG -x x.xg -g x.gcsa -j -M 2 | jq -r '.score' | tr '\n' ',')
@@ -94,6 +99,29 @@ is $(vg map -T x.reads -d x -j -t 1 | jq -c '.path.mapping[0].position.node_id'
 
 is $(vg map -T <(head -1 x.reads) -d x -j -t 1 -Q 30 | jq .mapping_quality) 30 "the mapping quality may be capped"
 
+vg map -T x.reads -d x -t 1 > x.plain.gam
+vg index -g x.gcsa -k 16 -K 6 x.vg
+is $(vg map -T x.reads -d x -t 1 | cmp - x.plain.gam && echo same) same "a k-mer range table doesn't change the mappings"
+rm -f x.plain.gam x.gcsa.kmers
+
+vg index -x x.xg -c x.vg
+is $(vg map -T x.reads -d x -j -t 1 | jq -c '.path.mapping[0].position.node_id' | wc -l) 1000 "vg map works with a snarl distance index"
+rm -f x.xg.dist
+
+vg map -T x.reads -d x -t 1 --stats >/dev/null 2>x.stats
+is $(grep ^reads x.stats | cut -f 2) 1000 "vg map reports how many reads it looked for seeds in"
+is $(awk '$1 == "exact" && $2 >= 1000 { print "yes" }' x.stats) yes "perfectly matching reads are aligned without dynamic programming"
+vg sim -s 1337 -n 100 -e 0.005 -x x.xg >x.err.reads
+vg map -T x.err.reads -d x -t 1 --stats >/dev/null 2>x.stats
+is $(awk '$1 == "ungapped" && $2 > 0 { print "yes" }' x.stats) yes "reads with mismatches can be aligned by ungapped extension"
+rm -f x.stats x.err.reads
+
+printf ">copies\nGATTACAGGCTTCAGTCCATGAACTGGTCAAGCTTAGCCGTAATCGGATCCTGACTTGCACTCGAGTTAACCGGTACGATGATTACATGCTTCAGTCCATGAACTGGTCAAGCTTAGCCGTAATCGGATCCTGACTTGCATGCATCGCGAAGTTCCAATGGATTACAGGCTTCAGTCCATGAACTGGTCAAGCTTAGCCGTAATCGGATCCTTACTTGCA\n" >copies.fa
+vg construct -r copies.fa >copies.vg
+vg index -x copies.xg -g copies.gcsa -k 16 copies.vg
+is $(vg map -s CAGGCTTCAGTCCATGAACTGGTCAAGCTTAGCCGTAATCGGATCCTGAC -x copies.xg -g copies.gcsa -M 3 -l 1 -j | wc -l) 3 "accepting a perfect alignment early doesn't drop the secondary alignments asked for"
+rm -f copies.fa copies.fa.fai copies.vg copies.xg copies.gcsa copies.gcsa.lcp
+
 vg index -x graphs/refonly-lrc_kir.vg.xg -g graphs/refonly-lrc_kir.vg.gcsa -k 16 graphs/refonly-lrc_kir.vg
 
 vg map -x graphs/refonly-lrc_kir.vg.xg -g graphs/refonly-lrc_kir.vg.gcsa -f reads/grch38_lrc_kir_paired.fq -i -u 4 -j  > temp_paired_alignment.json
@@ -106,6 +134,10 @@ paired_range=$(jq -r ".path.mapping[0].position.node_id" <  temp_paired_alignmen
 independent_range=$(jq -r ".path.mapping[0].position.node_id" <  temp_independent_alignment.json| sort | rs -T | awk '{print ($2 - $1)}')
 is $(printf "%s\t%s\n" $paired_range $independent_range | awk '{if ($1 < $2) print 1; else print 0}') 1 "paired read alignments forced to be consistent are closer together in node id space than unrestricted alignments"
 is $(vg map -x graphs/refonly-lrc_kir.vg.xg -g graphs/refonly-lrc_kir.vg.gcsa -f reads/grch38_lrc_kir_paired.fq -i -u 4 -j -M 4 | jq -r ".mapping_quality" | grep -v null | wc -l) 2 "only primary alignments have mapping quality scores"
+
+echo "1000:300:30:0:1" > frag.model
+is "$(vg map -x graphs/refonly-lrc_kir.vg.xg -g graphs/refonly-lrc_kir.vg.gcsa -f reads/grch38_lrc_kir_paired.fq -i -u 4 -j -F frag.model | md5sum)" "$(vg map -x graphs/refonly-lrc_kir.vg.xg -g graphs/refonly-lrc_kir.vg.gcsa -f reads/grch38_lrc_kir_paired.fq -i -u 4 -j -I 1000:300:30:0:1 | md5sum)" "a saved fragment model is used like --fragment"
+rm -f frag.model
 is $(vg map -T x.reads -x x.xg -g x.gcsa -k 22 -j | jq -r ".mapping_quality" | wc -l) 1000 "unpaired reads produce mapping quality scores"
 
 rm temp_paired_alignment.json temp_independent_alignment.json
@@ -6,7 +6,7 @@ BASH_TAP_ROOT=../deps/bash-tap
 PATH=../bin:$PATH # for vg
 
 
-plan tests 9
+plan tests 10
 
 vg construct -r small/x.fa -v small/x.vcf.gz >x.vg
 vg index -x x.xg x.vg
@@ -26,6 +26,9 @@ is $(vg sim -l 100 -n 100 -x x.xg -aJ | jq 'select(.path.mapping[0].is_reverse)'
 
 is $(vg sim -n 10 -i 0.005 -l 10 -p 50 -v 50 -s 42 -x x.xg -J | wc -l) 20 "pairs simulated even when fragments overlap"
 
+is $(diff <(vg sim -s 77 -n 5000 -l 50 -e 0.01 -t 1 -x x.xg) <(vg sim -s 77 -n 5000 -l 50 -e 0.01 -t 4 -x x.xg) | wc -l) 0 \
+   "threaded simulation produces the same reads regardless of thread count"
+
 cat tiny/tiny.fa | sed s/GCTTGGA/GCNTGGA/ >n.fa
 vg construct -r n.fa >n.vg
 vg index -x n.xg n.vg
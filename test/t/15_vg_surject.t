@@ -6,7 +6,7 @@ BASH_TAP_ROOT=../deps/bash-tap
 PATH=../bin:$PATH # for vg
 
 
-plan tests 11
+plan tests 15
 
 vg construct -r small/x.fa >j.vg
 vg index -x j.xg j.vg
@@ -37,6 +37,19 @@ is "$(vg map -s $SEQ -g x.gcsa -x x.xg | vg surject -p x -x x.xg - -s | cut -f1,
 is $(vg map -G <(vg sim -a -s 1337 -n 100 -x x.xg) -g x.gcsa -x x.xg | vg surject -p x -x x.xg -b - | samtools view - | wc -l) \
     100 "vg surject produces valid BAM output"
 
+# Reads at 105-150 on x, starting and ending partway through nodes. The ones
+# on the reference allele at 122 are projected straight onto the path, and the
+# ones taking the alternate allele have to be realigned to it.
+REF_READ=TTTGATTTATTTGAAGTGACGTTTGACAATCTATCACTAGGGGTAA
+REF_READ_RC=TTACCCCTAGTGATAGATTGTCAAACGTCACTTCAAATAAATCAAA
+ALT_READ=TTTGATTTATTTGAAGTAACGTTTGACAATCTATCACTAGGGGTAA
+ALT_READ_RC=TTACCCCTAGTGATAGATTGTCAAACGTTACTTCAAATAAATCAAA
+
+is "$(vg map -s $REF_READ -g x.gcsa -x x.xg | vg surject -p x -x x.xg -s - | grep -v ^@ | cut -f2,3,4,6 | tr '\t' ' ')" "0 x 105 46M" "projected surjection places a forward read"
+is "$(vg map -s $REF_READ_RC -g x.gcsa -x x.xg | vg surject -p x -x x.xg -s - | grep -v ^@ | cut -f2,3,4,6 | tr '\t' ' ')" "16 x 105 46M" "projected surjection places a reverse read"
+is "$(vg map -s $ALT_READ -g x.gcsa -x x.xg | vg surject -p x -x x.xg -s - | grep -v ^@ | cut -f2,3,4,6)" "$(vg map -s $REF_READ -g x.gcsa -x x.xg | vg surject -p x -x x.xg -s - | grep -v ^@ | cut -f2,3,4,6)" "projection and realignment agree on a forward read"
+is "$(vg map -s $ALT_READ_RC -g x.gcsa -x x.xg | vg surject -p x -x x.xg -b - | samtools view - | cut -f2,3,4,6)" "$(vg map -s $REF_READ_RC -g x.gcsa -x x.xg | vg surject -p x -x x.xg -b - | samtools view - | cut -f2,3,4,6)" "projection and realignment agree on a reverse read"
+
 #is $(vg map -G <(vg sim -a -s 1337 -n 100 x.vg) x.vg | vg surject -p x -g x.gcsa -x x.xg -c - | samtools view - | wc -l) \
 #    100 "vg surject produces valid CRAM output"
 
@@ -6,7 +6,7 @@ BASH_TAP_ROOT=../deps/bash-tap
 PATH=../bin:$PATH # for vg
 
 
-plan tests 3
+plan tests 4
 
 # Toy example of hand-made pileup (and hand inspected truth) to make sure some
 # obvious (and only obvious) SNPs are detected by vg call
@@ -16,7 +16,12 @@ vg view -J -l call/pileup.json -L > tiny.vgpu
 vg call tiny.vg tiny.vgpu -A calls_l.vg -s 10 -d 10 -q 10 -b 0.25  > /dev/null 2> /dev/null
 is $? "0" "vg call doesn't crash"
 
-rm -f calls_l.json calls_l.vg
+vg call tiny.vg tiny.vgpu -s 10 -d 10 -q 10 -b 0.25 > calls.vcf 2> /dev/null
+vg snarls calls_l.vg > calls_l.snarls
+vg call tiny.vg tiny.vgpu -s 10 -d 10 -q 10 -b 0.25 -L calls_l.snarls > calls_loaded.vcf 2> /dev/null
+is "$(diff calls.vcf calls_loaded.vcf | wc -l)" "0" "vg call makes the same calls with snarls loaded from a file"
+
+rm -f calls_l.json calls_l.vg calls_l.snarls calls.vcf calls_loaded.vcf
 
 vg view -J -l call/pileup.json -L | vg call tiny.vg - -A calls_l.vg -s 10 -d 10 -q 10 -b 0.25 -f 0.2 > /dev/null 2> /dev/null
 vg view -j calls_l.vg | jq . > calls_l.json
@@ -5,7 +5,19 @@ BASH_TAP_ROOT=../deps/bash-tap
 
 PATH=../bin:$PATH # for vg
 
-plan tests 0
+plan tests 3
+
+vg construct -r small/x.fa -v small/x.vcf.gz >x.vg
+vg index -x x.xg x.vg
+vg sim -s 1337 -n 100 -l 50 -a -x x.xg >x.gam
+
+is $(vg vectorize -s -x x.xg x.gam | wc -l) 100 "sparse vectorization produces one line per alignment"
+
+is $(vg vectorize -s -t 1 -x x.xg x.gam | sort | md5sum | cut -f 1 -d\ ) $(vg vectorize -s -t 4 -x x.xg x.gam | sort | md5sum | cut -f 1 -d\ ) "sparse vectorization is the same on multiple threads"
+
+is $(vg vectorize -b -l r -x x.xg x.gam | wc -c) $(vg vectorize -s -l r -x x.xg x.gam | awk '{ n += NF - 1; b += 8 + length($1) } END { print b + 16 * n }') "binary vectorization writes one record per alignment"
+
+rm -f x.vg x.xg x.gam
 
 #vg construct -r ../tiny/tiny.fa -v ../tiny/tiny.vcf.gz > tiny.vg
 #vg index -x tiny.xg -g tiny.gcsa -k 16 tiny.vg
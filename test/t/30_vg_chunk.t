@@ -5,7 +5,7 @@ BASH_TAP_ROOT=../deps/bash-tap
 
 PATH=../bin:$PATH # for vg
 
-plan tests 7
+plan tests 8
 
 vg construct -r small/x.fa -v small/x.vcf.gz >x.vg
 vg index -x x.xg  x.vg
@@ -34,5 +34,13 @@ is $(ls -l _chunk_test*.vg | wc -l) 2 "gam chunker produces correct number of gr
 is $(ls -l _chunk_test*.gam | wc -l) 2 "gam chunker produces correct number of gams"
 is $(grep x _chunk_test_out.bed | wc -l) 2 "gam chunker prodcues bed with correct number of chunks"
 
+#check that streaming the gam gets the same reads as using the index
+vg view -a _chunk_test_0_*.gam | jq -r .name | sort > _chunk_test_index_reads.txt
+rm -f _chunk_test*.gam
+vg chunk -x x.xg -G x.gam -b _chunk_test -r _chunk_test_bed.bed
+vg view -a _chunk_test_0_*.gam | jq -r .name | sort > _chunk_test_stream_reads.txt
+diff _chunk_test_index_reads.txt _chunk_test_stream_reads.txt
+is $? 0 "streaming gam chunker finds the same reads as the indexed gam chunker"
+
 rm -rf x.gam.index _chunk_test_bed.bed _chunk_test*
 rm -f x.vg x.xg x.gam x.gam.json filter_chunk*.gam chunks.bed
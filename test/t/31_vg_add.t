@@ -5,7 +5,7 @@ BASH_TAP_ROOT=../deps/bash-tap
 
 PATH=../bin:$PATH # for vg
 
-plan tests 7
+plan tests 10
 
 vg construct -r add/ref.fa > ref.vg
 vg add -v add/benedict.vcf ref.vg > benedict.vg
@@ -27,4 +27,20 @@ is "$(vg view -Jv add/backward.json | vg add -v add/benedict.vcf - | vg stats -N
 
 is "$(vg view -Jv add/backward_and_forward.json | vg add -v add/benedict.vcf - | vg mod --unchop - | vg stats -N -)" "5" "graphs with backward and forward nodes can be added to"
 
-rm -rf ref.vg benedict.vg benedict.vg x-ref.vg x.vg
+is "$(vg add -t 2 -v small/x.vcf.gz ref.vg 2>&1 >/dev/null | grep -c 'Contig x mentioned in VCF but not found in graph')" "1" "adding variants in parallel complains about contigs missing from the graph"
+
+is "$(vg add -t 2 -i -v small/x.vcf.gz ref.vg 2>&1 >/dev/null | grep -c 'skipping missing contig x')" "1" "adding variants in parallel can skip contigs missing from the graph"
+
+# Summarize a graph without its node IDs, which threads may hand out in any order
+graph_summary() {
+    vg stats -N -E -l "$1"
+    vg view -j "$1" | jq -c '(.node | map({key: (.id | tostring), value: .sequence}) | from_entries) as $seqs |
+        [(.node | map(.sequence) | sort), (.path | sort_by(.name) | map([.name, (.mapping | map($seqs[.position.node_id | tostring]))]))]'
+}
+
+vg construct -r add/multi.fa > multi-ref.vg
+vg add -t 1 -v add/multi.vcf.gz multi-ref.vg > multi-serial.vg
+vg add -t 4 -v add/multi.vcf.gz multi-ref.vg > multi-parallel.vg
+is "$(graph_summary multi-parallel.vg)" "$(graph_summary multi-serial.vg)" "adding variants on several contigs in parallel produces the same graph as adding them serially"
+
+rm -rf ref.vg benedict.vg benedict.vg x-ref.vg x.vg multi-ref.vg multi-serial.vg multi-parallel.vg
@@ -5,7 +5,7 @@ BASH_TAP_ROOT=../deps/bash-tap
 
 PATH=../bin:$PATH # for vg
 
-plan tests 8
+plan tests 9
 
 vg construct -r tiny/tiny.fa -v tiny/tiny.vcf.gz >t.vg
 
@@ -26,7 +26,11 @@ vg view -J -v snarls/snarls.json > snarls.vg
 is $(vg snarls snarls.vg -r st.pb | vg view -R - | wc -l) 3 "vg snarls made right number of protobuf Snarls"
 is $(vg view -E st.pb | wc -l) 6 "vg snarls made right number of protobuf SnarlTraversals"
 
-rm -f snarls.vg sb.txt cb.txt st.pb 
+vg snarls snarls.vg > s.pb
+vg snarls snarls.vg -L s.pb -r st_loaded.pb > s_loaded.pb
+is $(vg view -E st.pb | sort | md5sum | cut -f 1 -d\ ) $(vg view -E st_loaded.pb | sort | md5sum | cut -f 1 -d\ ) "vg snarls finds the same traversals with snarls loaded from a file"
+
+rm -f snarls.vg sb.txt cb.txt st.pb s.pb s_loaded.pb st_loaded.pb
 
 vg construct -r tiny/tiny.fa -v tiny/tiny.vcf.gz | vg mod -X 1 - > tiny.vg
 